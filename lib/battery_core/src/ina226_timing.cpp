@@ -0,0 +1,17 @@
+#include "ina226_timing.h" // 包含INA226转换耗时计算的头文件
+
+static constexpr uint16_t k_average_counts[] = {1, 4, 16, 64, 128, 256, 512, 1024}; // INA226平均点数枚举对应的次数
+static constexpr uint16_t k_conversion_time_us[] = {140, 204, 332, 588, 1100, 2100, 4200, 8300}; // INA226转换时间枚举对应的微秒数
+static constexpr uint8_t k_max_setting_index = 7; // 两个枚举的最大值
+
+uint32_t get_ina226_conversion_us(uint8_t average, uint8_t conversion_time)
+{
+  const uint8_t average_index = average <= k_max_setting_index ? average : k_max_setting_index; // 限制在枚举范围内
+  const uint8_t time_index = conversion_time <= k_max_setting_index ? conversion_time : k_max_setting_index; // 限制在枚举范围内
+  return static_cast<uint32_t>(k_average_counts[average_index]) * k_conversion_time_us[time_index]; // 平均点数*单次转换时间
+}
+
+uint32_t get_ina226_conversion_timeout_ms(uint32_t expected_us)
+{
+  return expected_us / 1000UL * 2UL + 10UL; // 两倍裕量再加固定余量
+}
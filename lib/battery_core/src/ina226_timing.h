@@ -0,0 +1,18 @@
+#pragma once // 防止头文件重复包含
+
+#include <stdint.h> // 包含定宽整数类型
+
+/**
+ * @brief 按平均点数与转换时间计算INA226单个通道完成一次转换的耗时
+ * @param average 平均点数枚举(0-7),超出范围按最大值计算
+ * @param conversion_time 转换时间枚举(0-7),超出范围按最大值计算
+ * @return 预计耗时(us),为标称值,未计内部时钟误差
+ */
+uint32_t get_ina226_conversion_us(uint8_t average, uint8_t conversion_time);
+
+/**
+ * @brief 按预计耗时计算等待转换完成的超时时间
+ * @param expected_us 预计耗时(us)
+ * @return 超时时间(ms),留出两倍裕量(内部时钟误差)
+ */
+uint32_t get_ina226_conversion_timeout_ms(uint32_t expected_us);
@@ -0,0 +1,86 @@
+#include "monotonic_clock.h" // 包含单调时间基准的头文件
+
+#include <sys/time.h> // 包含系统时间接口
+
+static constexpr uint64_t k_min_valid_epoch_ms = 1577836800000ULL; // 2020-01-01,早于此值的系统时间视为未设置
+
+uint64_t MonotonicClock::extend(uint32_t now_ms)
+{
+  if (!is_started_) // 首次调用
+  {
+    is_started_ = true; // 标记已开始
+    last_low_ms_ = now_ms; // 记录时间戳
+    monotonic_ms_ = now_ms; // 以当前时间为起点
+    return monotonic_ms_; // 返回单调时间
+  }
+
+  const uint32_t delta_ms = now_ms - last_low_ms_; // 无符号相减,自动处理32位回绕
+  if ((delta_ms & 0x80000000u) != 0) // 差值为负(时间戳倒退)
+  {
+    return monotonic_ms_; // 保持不变,不误判为回绕
+  }
+
+  last_low_ms_ = now_ms; // 记录时间戳
+  monotonic_ms_ += delta_ms; // 累加前进量
+  return monotonic_ms_; // 返回单调时间
+}
+
+void MonotonicClock::resume(uint64_t monotonic_ms, uint32_t now_ms)
+{
+  is_started_ = true; // 标记已开始
+  last_low_ms_ = now_ms; // 以当前时间戳为基准
+  monotonic_ms_ = monotonic_ms; // 从复位前的时间继续
+}
+
+void MonotonicClock::set_epoch_ms(uint64_t epoch_ms, uint32_t now_ms)
+{
+  const uint64_t monotonic_ms = extend(now_ms); // 当前单调时间
+  epoch_offset_ms_ = static_cast<int64_t>(epoch_ms) - static_cast<int64_t>(monotonic_ms); // 计算偏移
+  has_epoch_ = true; // 标记已知绝对时间
+}
+
+bool MonotonicClock::sync_epoch_from_system_time(uint32_t now_ms)
+{
+  struct timeval tv; // 系统时间结构
+  if (gettimeofday(&tv, nullptr) != 0) // 读取系统时间
+  {
+    return false; // 读取失败
+  }
+
+  const uint64_t epoch_ms = static_cast<uint64_t>(tv.tv_sec) * 1000ULL + static_cast<uint64_t>(tv.tv_usec) / 1000ULL; // 换算为毫秒
+  if (epoch_ms < k_min_valid_epoch_ms) // 系统时间未被设置
+  {
+    return false; // 返回失败
+  }
+
+  epoch_offset_ms_ = static_cast<int64_t>(epoch_ms) - static_cast<int64_t>(extend(now_ms)); // 计算偏移
+  has_epoch_ = true; // 标记已知绝对时间
+  return true; // 同步成功
+}
+
+void MonotonicClock::write_system_time(uint64_t epoch_ms)
+{
+  struct timeval tv; // 系统时间结构
+  tv.tv_sec = static_cast<time_t>(epoch_ms / 1000ULL); // 秒
+  tv.tv_usec = static_cast<suseconds_t>((epoch_ms % 1000ULL) * 1000ULL); // 微秒
+  settimeofday(&tv, nullptr); // 同步系统时间
+}
+
+bool MonotonicClock::has_epoch() const
+{
+  return has_epoch_; // 返回是否已知绝对时间
+}
+
+uint64_t MonotonicClock::to_epoch_ms(uint64_t monotonic_ms) const
+{
+  if (!has_epoch_) // 绝对时间未知
+  {
+    return 0; // 返回0
+  }
+  return static_cast<uint64_t>(static_cast<int64_t>(monotonic_ms) + epoch_offset_ms_); // 叠加偏移
+}
+
+uint64_t MonotonicClock::to_record_timestamp_ms(uint64_t monotonic_ms) const
+{
+  return has_epoch_ ? to_epoch_ms(monotonic_ms) : monotonic_ms; // 优先使用绝对时间
+}
@@ -0,0 +1,76 @@
+#pragma once // 防止头文件重复包含
+
+#include <stdint.h> // 包含定宽整数类型
+
+/**
+ * @brief 64位单调时间基准,可选叠加RTC/NTP提供的绝对时间偏移
+ * @note 把32位millis()扩展为64位,只要相邻两次调用间隔小于约24.8天即可正确跨越49.7天回绕
+ * @note 不读取millis(),当前时间由调用者传入,可在主机上测试
+ */
+class MonotonicClock
+{
+public:
+  /**
+   * @brief 将32位毫秒时间戳扩展为64位单调时间
+   * @param now_ms 当前32位时间戳(ms),通常来自millis()
+   * @return 64位单调时间(ms)
+   * @note 时间戳小幅倒退(如调用者先取时间后更新)时保持不变,不会误判为回绕
+   */
+  uint64_t extend(uint32_t now_ms);
+
+  /**
+   * @brief 从复位前的单调时间继续计时(热重启恢复)
+   * @param monotonic_ms 复位前最后的64位单调时间(ms)
+   * @param now_ms 当前32位时间戳(ms),之后的extend()以此为基准累加
+   * @note 复位期间的时间不计入
+   */
+  void resume(uint64_t monotonic_ms, uint32_t now_ms);
+
+  /**
+   * @brief 设置当前的绝对时间(Unix时间,ms)
+   * @param epoch_ms 当前Unix时间(ms)
+   * @param now_ms 当前32位时间戳(ms)
+   * @note 只更新偏移;需要软件复位和深度睡眠后仍有效时,调用者另行调用write_system_time()
+   */
+  void set_epoch_ms(uint64_t epoch_ms, uint32_t now_ms);
+
+  /**
+   * @brief 若系统时间有效(已由RTC/NTP设置),从系统时间同步绝对时间偏移
+   * @param now_ms 当前32位时间戳(ms)
+   * @return true 同步成功, false 系统时间无效
+   */
+  bool sync_epoch_from_system_time(uint32_t now_ms);
+
+  /**
+   * @brief 将Unix时间写入系统时间,软件复位和深度睡眠后可由sync_epoch_from_system_time()恢复
+   * @param epoch_ms Unix时间(ms)
+   */
+  static void write_system_time(uint64_t epoch_ms);
+
+  /**
+   * @brief 是否已知绝对时间
+   * @return true 已知, false 未知
+   */
+  bool has_epoch() const;
+
+  /**
+   * @brief 将单调时间换算为Unix时间
+   * @param monotonic_ms 64位单调时间(ms)
+   * @return Unix时间(ms),绝对时间未知时返回0
+   */
+  uint64_t to_epoch_ms(uint64_t monotonic_ms) const;
+
+  /**
+   * @brief 获取用于持久化记录的时间戳
+   * @param monotonic_ms 64位单调时间(ms)
+   * @return 已知绝对时间时为Unix时间,否则为本次启动的单调时间
+   */
+  uint64_t to_record_timestamp_ms(uint64_t monotonic_ms) const;
+
+private:
+  uint32_t last_low_ms_ = 0; // 上次扩展时的32位时间戳
+  uint64_t monotonic_ms_ = 0; // 当前64位单调时间
+  bool is_started_ = false; // 是否已扩展过至少一次
+  bool has_epoch_ = false; // 是否已知绝对时间
+  int64_t epoch_offset_ms_ = 0; // Unix时间与单调时间的差值(ms)
+};
@@ -0,0 +1,84 @@
+#include "runtime_predictor.h" // 包含剩余时间预测器的头文件
+
+#include <math.h> // 包含数学库
+
+RuntimePredictor::RuntimePredictor(const Config &config)
+    : config_(config), // 初始化配置结构体
+      filtered_current_ma_(NAN), // 尚未更新
+      filtered_power_mw_(NAN) // 尚未更新
+{
+}
+
+RuntimePredictor::Prediction RuntimePredictor::update(uint32_t elapsed_ms, float current_ma, float bus_voltage_v, double remaining_capacity_mah,
+                                                      double full_capacity_mah)
+{
+  const float power_mw = bus_voltage_v * current_ma; // 计算带符号功率(放电为正)
+  if (isnan(filtered_current_ma_) || isnan(filtered_power_mw_)) // 首次更新时直接用当前值初始化滤波器
+  {
+    filtered_current_ma_ = current_ma; // 初始化平滑电流
+    filtered_power_mw_ = power_mw; // 初始化平滑功率
+  }
+  else
+  {
+    const float dt_s = static_cast<float>(elapsed_ms) * 0.001f; // 时间差转换为秒
+    const float tau_s = config_.filter_time_constant_s > 0.0f ? config_.filter_time_constant_s : 0.0f; // 时间常数(非正数表示不平滑)
+    const float alpha = (tau_s + dt_s) > 0.0f ? dt_s / (tau_s + dt_s) : 1.0f; // 一阶低通系数,适配不均匀的采样间隔
+    filtered_current_ma_ += alpha * (current_ma - filtered_current_ma_); // 更新平滑电流
+    filtered_power_mw_ += alpha * (power_mw - filtered_power_mw_); // 更新平滑功率
+  }
+
+  Prediction prediction{}; // 预测结果
+  prediction.avg_current_ma = filtered_current_ma_; // 平滑电流
+  prediction.time_to_empty_min = NAN; // 默认无放空时间
+  prediction.time_to_full_min = NAN; // 默认无充满时间
+
+  const float threshold_ma = config_.idle_threshold_ma > 0.0f ? config_.idle_threshold_ma : 0.0f; // 低于死区的平滑电流视为静置
+  if (filtered_current_ma_ <= threshold_ma && filtered_current_ma_ >= -threshold_ma) // 静置状态不做预测
+  {
+    return prediction; // 直接返回
+  }
+
+  const bool is_discharging = filtered_current_ma_ > 0.0f; // 判断充放电方向
+  const double capacity_to_go_mah = is_discharging ? remaining_capacity_mah : (full_capacity_mah - remaining_capacity_mah); // 放电时为剩余容量,充电时为待充容量
+  float hours = NAN; // 预测的小时数
+  if (config_.is_constant_power && fabsf(filtered_power_mw_) > 0.0f && bus_voltage_v > 0.0f) // 恒功率负载：按剩余能量/平均功率预测
+  {
+    hours = static_cast<float>(capacity_to_go_mah) * bus_voltage_v / fabsf(filtered_power_mw_); // 剩余能量(mWh)近似为容量*当前电压
+  }
+  else
+  {
+    hours = static_cast<float>(capacity_to_go_mah) / fabsf(filtered_current_ma_); // 恒流负载：按剩余容量/平均电流预测
+  }
+
+  if (is_discharging) // 放电方向
+  {
+    prediction.time_to_empty_min = hours * 60.0f; // 输出预计放空时间(min)
+  }
+  else
+  {
+    prediction.time_to_full_min = hours * 60.0f; // 输出预计充满时间(min)
+  }
+  return prediction; // 返回预测结果
+}
+
+void RuntimePredictor::reset()
+{
+  filtered_current_ma_ = NAN; // 清除平滑电流
+  filtered_power_mw_ = NAN; // 清除平滑功率
+}
+
+void RuntimePredictor::restore(float filtered_current_ma, float filtered_power_mw)
+{
+  filtered_current_ma_ = filtered_current_ma; // 恢复平滑电流
+  filtered_power_mw_ = filtered_power_mw; // 恢复平滑功率
+}
+
+float RuntimePredictor::get_filtered_current_ma() const
+{
+  return filtered_current_ma_; // 返回平滑电流
+}
+
+float RuntimePredictor::get_filtered_power_mw() const
+{
+  return filtered_power_mw_; // 返回平滑功率
+}
@@ -0,0 +1,77 @@
+#pragma once // 防止头文件重复包含
+
+#include <stdint.h> // 包含定宽整数类型
+
+/**
+ * @brief 剩余时间预测器:对电流/功率做一阶低通平滑,按剩余容量估算放空或充满时间
+ * @note 不依赖Arduino,可在主机上用记录的放电曲线回放测试
+ */
+class RuntimePredictor
+{
+public:
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    float filter_time_constant_s = 60.0f; // 电流/功率平滑时间常数(s),非正数表示不平滑
+    float idle_threshold_ma = 0.0f; // 平滑电流绝对值不超过此值(mA)时视为静置,不做预测
+    bool is_constant_power = false; // 是否按恒功率负载预测(使用功率而非电流)
+  };
+
+  /**
+   * @brief 预测结果
+   */
+  struct Prediction
+  {
+    float avg_current_ma = 0.0f; // 平滑后的电流(mA),放电为正
+    float time_to_empty_min = 0.0f; // 预计放空时间(min),非放电状态为NAN
+    float time_to_full_min = 0.0f; // 预计充满时间(min),非充电状态为NAN
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit RuntimePredictor(const Config &config);
+
+  /**
+   * @brief 加入一个积分周期的电流并更新预测
+   * @param elapsed_ms 距上次更新的时间(ms)
+   * @param current_ma 本周期的有效电流(mA),放电为正
+   * @param bus_voltage_v 总线电压(V)
+   * @param remaining_capacity_mah 当前剩余容量(mAh)
+   * @param full_capacity_mah 满容量(mAh)
+   * @return 预测结果
+   */
+  Prediction update(uint32_t elapsed_ms, float current_ma, float bus_voltage_v, double remaining_capacity_mah, double full_capacity_mah);
+
+  /**
+   * @brief 清除平滑状态,下一次更新直接以当前值初始化
+   */
+  void reset();
+
+  /**
+   * @brief 恢复平滑状态(热重启)
+   * @param filtered_current_ma 平滑电流(mA)
+   * @param filtered_power_mw 平滑功率(mW)
+   */
+  void restore(float filtered_current_ma, float filtered_power_mw);
+
+  /**
+   * @brief 获取平滑电流
+   * @return 平滑电流(mA),尚未更新时为NAN
+   */
+  float get_filtered_current_ma() const;
+
+  /**
+   * @brief 获取平滑功率
+   * @return 平滑功率(mW),尚未更新时为NAN
+   */
+  float get_filtered_power_mw() const;
+
+private:
+  Config config_{}; // 配置副本
+  float filtered_current_ma_; // 平滑后的电流(mA)
+  float filtered_power_mw_; // 平滑后的功率(mW)
+};
@@ -0,0 +1,123 @@
+#include "battery_chemistry_profiles.h" // 包含电池化学体系预设的头文件
+
+// 三元/钴酸锂单节静置开路电压-SOC对照表
+static constexpr Ina226BatteryMonitor::SocPoint k_li_ion_cell_ocv_table[] = {
+    {4.20f, 100.0f}, // 4.20V 对应 100%
+    {4.08f, 90.0f},  // 4.08V 对应 90%
+    {3.99f, 80.0f},  // 3.99V 对应 80%
+    {3.91f, 70.0f},  // 3.91V 对应 70%
+    {3.84f, 60.0f},  // 3.84V 对应 60%
+    {3.79f, 50.0f},  // 3.79V 对应 50%
+    {3.75f, 40.0f},  // 3.75V 对应 40%
+    {3.71f, 30.0f},  // 3.71V 对应 30%
+    {3.66f, 20.0f},  // 3.66V 对应 20%
+    {3.55f, 10.0f},  // 3.55V 对应 10%
+    {3.00f, 0.0f},   // 3.00V 对应 0%
+};
+
+// 磷酸铁锂单节静置开路电压-SOC对照表(20%-90%区间非常平坦)
+static constexpr Ina226BatteryMonitor::SocPoint k_lifepo4_cell_ocv_table[] = {
+    {3.40f, 100.0f}, // 3.40V 对应 100%
+    {3.35f, 90.0f},  // 3.35V 对应 90%
+    {3.32f, 80.0f},  // 3.32V 对应 80%
+    {3.30f, 70.0f},  // 3.30V 对应 70%
+    {3.27f, 60.0f},  // 3.27V 对应 60%
+    {3.26f, 50.0f},  // 3.26V 对应 50%
+    {3.25f, 40.0f},  // 3.25V 对应 40%
+    {3.22f, 30.0f},  // 3.22V 对应 30%
+    {3.20f, 20.0f},  // 3.20V 对应 20%
+    {3.00f, 10.0f},  // 3.00V 对应 10%
+    {2.50f, 0.0f},   // 2.50V 对应 0%
+};
+
+// 铅酸单格静置开路电压-SOC对照表
+static constexpr Ina226BatteryMonitor::SocPoint k_lead_acid_cell_ocv_table[] = {
+    {2.122f, 100.0f}, // 2.122V 对应 100%
+    {2.103f, 90.0f},  // 2.103V 对应 90%
+    {2.083f, 80.0f},  // 2.083V 对应 80%
+    {2.062f, 70.0f},  // 2.062V 对应 70%
+    {2.040f, 60.0f},  // 2.040V 对应 60%
+    {2.017f, 50.0f},  // 2.017V 对应 50%
+    {1.993f, 40.0f},  // 1.993V 对应 40%
+    {1.968f, 30.0f},  // 1.968V 对应 30%
+    {1.943f, 20.0f},  // 1.943V 对应 20%
+    {1.918f, 10.0f},  // 1.918V 对应 10%
+    {1.750f, 0.0f},   // 1.750V 对应 0%
+};
+
+// 锂离子温度-有效容量系数
+static constexpr Ina226BatteryMonitor::TemperatureFactorPoint k_li_ion_capacity_temp_table[] = {
+    {-20.0f, 0.60f}, // -20°C 有效容量60%
+    {0.0f, 0.85f},   // 0°C 有效容量85%
+    {25.0f, 1.00f},  // 25°C 额定容量
+    {45.0f, 1.00f},  // 45°C 额定容量
+};
+
+// 锂离子温度-充电效率系数(低温充电析锂,效率下降)
+static constexpr Ina226BatteryMonitor::TemperatureFactorPoint k_li_ion_charge_temp_table[] = {
+    {0.0f, 0.95f},  // 0°C 效率系数0.95
+    {15.0f, 1.00f}, // 15°C 及以上不修正
+};
+
+// 磷酸铁锂温度-有效容量系数
+static constexpr Ina226BatteryMonitor::TemperatureFactorPoint k_lifepo4_capacity_temp_table[] = {
+    {-20.0f, 0.55f}, // -20°C 有效容量55%
+    {0.0f, 0.80f},   // 0°C 有效容量80%
+    {25.0f, 1.00f},  // 25°C 额定容量
+    {45.0f, 1.00f},  // 45°C 额定容量
+};
+
+// 铅酸温度-有效容量系数
+static constexpr Ina226BatteryMonitor::TemperatureFactorPoint k_lead_acid_capacity_temp_table[] = {
+    {-20.0f, 0.50f}, // -20°C 有效容量50%
+    {0.0f, 0.80f},   // 0°C 有效容量80%
+    {25.0f, 1.00f},  // 25°C 额定容量
+    {40.0f, 1.05f},  // 40°C 有效容量略高
+};
+
+// 铅酸温度-充电效率系数
+static constexpr Ina226BatteryMonitor::TemperatureFactorPoint k_lead_acid_charge_temp_table[] = {
+    {0.0f, 0.90f},  // 0°C 效率系数0.90
+    {25.0f, 1.00f}, // 25°C 不修正
+    {40.0f, 0.97f}, // 高温析气,效率略降
+};
+
+#define TABLE_LEN(table) (sizeof(table) / sizeof((table)[0])) // 计算静态数组长度
+
+static constexpr size_t k_li_ion_table_len = TABLE_LEN(k_li_ion_cell_ocv_table); // 锂离子查表长度
+static constexpr size_t k_lifepo4_table_len = TABLE_LEN(k_lifepo4_cell_ocv_table); // 磷酸铁锂查表长度
+static constexpr size_t k_lead_acid_table_len = TABLE_LEN(k_lead_acid_cell_ocv_table); // 铅酸查表长度
+
+static constexpr uint32_t k_minutes_ms = 60UL * 1000UL; // 一分钟对应的毫秒数
+
+// 内置预设,顺序与BatteryPreset枚举一致(CUSTOM除外)
+static constexpr BatteryChemistryProfile k_battery_chemistry_profiles[] = {
+    {"Li-ion 1S", k_li_ion_cell_ocv_table, k_li_ion_table_len, 1, 4.15f, 0.02f, 0.99f, 1.05f, 2.0f, 0.002f, 30 * k_minutes_ms, 0.0f, 0.0f,
+     k_li_ion_capacity_temp_table, TABLE_LEN(k_li_ion_capacity_temp_table), k_li_ion_charge_temp_table, TABLE_LEN(k_li_ion_charge_temp_table)}, // 锂离子1串
+    {"Li-ion 2S", k_li_ion_cell_ocv_table, k_li_ion_table_len, 2, 4.15f, 0.02f, 0.99f, 1.05f, 2.0f, 0.002f, 30 * k_minutes_ms, 0.0f, 0.0f,
+     k_li_ion_capacity_temp_table, TABLE_LEN(k_li_ion_capacity_temp_table), k_li_ion_charge_temp_table, TABLE_LEN(k_li_ion_charge_temp_table)}, // 锂离子2串
+    {"Li-ion 3S", k_li_ion_cell_ocv_table, k_li_ion_table_len, 3, 4.15f, 0.02f, 0.99f, 1.05f, 2.0f, 0.002f, 30 * k_minutes_ms, 0.0f, 0.0f,
+     k_li_ion_capacity_temp_table, TABLE_LEN(k_li_ion_capacity_temp_table), k_li_ion_charge_temp_table, TABLE_LEN(k_li_ion_charge_temp_table)}, // 锂离子3串
+    {"Li-ion 4S", k_li_ion_cell_ocv_table, k_li_ion_table_len, 4, 4.15f, 0.02f, 0.99f, 1.05f, 2.0f, 0.002f, 30 * k_minutes_ms, 0.0f, 0.0f,
+     k_li_ion_capacity_temp_table, TABLE_LEN(k_li_ion_capacity_temp_table), k_li_ion_charge_temp_table, TABLE_LEN(k_li_ion_charge_temp_table)}, // 锂离子4串
+    {"LiFePO4 1S", k_lifepo4_cell_ocv_table, k_lifepo4_table_len, 1, 3.45f, 0.03f, 0.99f, 1.03f, 3.0f, 0.002f, 120 * k_minutes_ms, 20.0f, 90.0f,
+     k_lifepo4_capacity_temp_table, TABLE_LEN(k_lifepo4_capacity_temp_table), k_li_ion_charge_temp_table, TABLE_LEN(k_li_ion_charge_temp_table)}, // 磷酸铁锂1串,平台区内不按电压校准
+    {"LiFePO4 4S", k_lifepo4_cell_ocv_table, k_lifepo4_table_len, 4, 3.45f, 0.03f, 0.99f, 1.03f, 3.0f, 0.002f, 120 * k_minutes_ms, 20.0f, 90.0f,
+     k_lifepo4_capacity_temp_table, TABLE_LEN(k_lifepo4_capacity_temp_table), k_li_ion_charge_temp_table, TABLE_LEN(k_li_ion_charge_temp_table)}, // 磷酸铁锂4串,平台区内不按电压校准
+    {"Lead-acid 12V", k_lead_acid_cell_ocv_table, k_lead_acid_table_len, 6, 2.35f, 0.01f, 0.85f, 1.25f, 4.0f, 0.001f, 240 * k_minutes_ms, 0.0f, 0.0f,
+     k_lead_acid_capacity_temp_table, TABLE_LEN(k_lead_acid_capacity_temp_table), k_lead_acid_charge_temp_table, TABLE_LEN(k_lead_acid_charge_temp_table)}, // 铅酸12V(6格),需要长时间静置
+};
+
+static_assert(TABLE_LEN(k_battery_chemistry_profiles) ==
+                  static_cast<size_t>(Ina226BatteryMonitor::BatteryPreset::LEAD_ACID_12V), // 预设数量必须与枚举一致
+              "Battery preset table does not match BatteryPreset");
+
+const BatteryChemistryProfile *get_battery_chemistry_profile(Ina226BatteryMonitor::BatteryPreset preset)
+{
+  const size_t index = static_cast<size_t>(preset); // 枚举值作为下标
+  if (index == 0 || index > TABLE_LEN(k_battery_chemistry_profiles)) // CUSTOM或越界
+  {
+    return nullptr; // 无内置预设
+  }
+  return &k_battery_chemistry_profiles[index - 1]; // 返回对应预设(CUSTOM占用0)
+}
@@ -0,0 +1,35 @@
+#pragma once // 防止头文件重复包含
+
+#include "ina226_battery_monitor.h" // 包含INA226电池监视器的头文件
+
+/**
+ * @brief 电池化学体系预设参数结构体
+ * @note 所有预设均为constexpr数据,存放在Flash中
+ */
+struct BatteryChemistryProfile
+{
+  const char *name; // 预设名称
+  const Ina226BatteryMonitor::SocPoint *cell_ocv_table; // 单节开路电压-SOC查表(按电压降序)
+  size_t cell_ocv_table_len; // 单节开路电压-SOC查表长度
+  uint8_t cell_count; // 串联节数
+  float full_charge_cell_voltage_v; // 单节满充判定电压(V)
+  float full_charge_current_c_rate; // 满充判定截止电流(C),乘以容量得到mA
+  float charge_efficiency; // 典型充电库仑效率(0-1)
+  float peukert_exponent; // 典型Peukert指数
+  float self_discharge_percent_per_month; // 典型月自放电率(%)
+  float rest_current_c_rate; // 判定静置的电流上限(C)
+  uint32_t rest_recalibration_ms; // 静置多久后允许按开路电压校准(ms)
+  float ocv_plateau_min_soc_percent; // 开路电压平台区下限(%),平台区内不按电压校准
+  float ocv_plateau_max_soc_percent; // 开路电压平台区上限(%)
+  const Ina226BatteryMonitor::TemperatureFactorPoint *capacity_temp_table; // 温度-有效容量系数查表
+  size_t capacity_temp_table_len; // 温度-有效容量系数查表长度
+  const Ina226BatteryMonitor::TemperatureFactorPoint *charge_efficiency_temp_table; // 温度-充电效率系数查表
+  size_t charge_efficiency_temp_table_len; // 温度-充电效率系数查表长度
+};
+
+/**
+ * @brief 获取内置的电池化学体系预设
+ * @param preset 预设类型
+ * @return 预设参数指针, CUSTOM或未知类型返回nullptr
+ */
+const BatteryChemistryProfile *get_battery_chemistry_profile(Ina226BatteryMonitor::BatteryPreset preset);
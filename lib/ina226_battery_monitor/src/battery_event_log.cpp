@@ -0,0 +1,194 @@
+#include "battery_event_log.h" // 包含电池事件日志的头文件
+
+#include "ina226_battery_monitor.h" // 包含INA226电池监视器的头文件(CRC32计算)
+
+#include <stddef.h> // 包含标准定义库
+#include <stdio.h> // 包含标准输入输出库
+
+static constexpr uint32_t k_flash_sector_size = 4096; // Flash扇区大小
+static constexpr uint32_t k_blank_sequence = 0xFFFFFFFFu; // 擦除后的序号值
+static constexpr esp_partition_subtype_t k_event_log_subtype = static_cast<esp_partition_subtype_t>(0x40); // 自定义数据分区子类型
+
+static_assert(sizeof(BatteryEventLog::EventEntry) == 32, "EventEntry must stay 32 bytes"); // 保证扇区内整数条记录
+
+// 事件类型名称,顺序与BatteryEventType一致
+static const char *const k_event_type_names[] = {
+    "BOOT",                   // 启动
+    "BROWNOUT_RESET",         // 欠压复位
+    "FULL_CHARGE",            // 满充
+    "DEEP_DISCHARGE",         // 深度放电
+    "SOC_RESET_FROM_VOLTAGE", // 按电压重置
+    "NVS_CLEARED",            // 清除NVS
+    "NVS_LOAD_FAILED",        // NVS加载失败
+    "NVS_SAVE_FAILED",        // NVS保存失败
+    "REST_RECALIBRATION",     // 静置校准
+    "PROTECTION_TRIP",        // 保护触发
+    "PROTECTION_CLEAR",       // 保护解除
+    "EFFICIENCY_LEARNED",     // 效率学习
+    "BOOT_SOC_ARBITRATED",    // 启动SOC仲裁
+};
+
+static_assert(sizeof(k_event_type_names) / sizeof(k_event_type_names[0]) == static_cast<size_t>(BatteryEventType::BOOT_SOC_ARBITRATED) + 1, // 名称表必须覆盖全部类型
+              "Event name table does not match BatteryEventType");
+
+BatteryEventLog::BatteryEventLog(const char *partition_label)
+    : partition_label_(partition_label) // 初始化分区标签
+{
+}
+
+bool BatteryEventLog::begin()
+{
+  partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, k_event_log_subtype, partition_label_); // 查找日志分区
+  if (partition_ == nullptr || partition_->size < 2 * k_flash_sector_size) // 分区不存在或不足两个扇区
+  {
+    partition_ = nullptr; // 标记不可用
+    return false; // 返回失败
+  }
+
+  slots_per_sector_ = k_flash_sector_size / sizeof(EventEntry); // 每个扇区的记录条数
+  slot_count_ = (partition_->size / k_flash_sector_size) * slots_per_sector_; // 分区总记录条数
+
+  bool has_entry = false; // 是否找到有效记录
+  uint32_t newest_sequence = 0; // 最新记录的序号
+  uint32_t newest_slot = 0; // 最新记录的槽位
+  for (uint32_t slot = 0; slot < slot_count_; slot++) // 扫描全部槽位
+  {
+    EventEntry entry{}; // 记录缓冲
+    if (!read_entry(slot, entry)) // 空槽或无效记录
+    {
+      continue; // 跳过
+    }
+    if (!has_entry || static_cast<int32_t>(entry.sequence - newest_sequence) > 0) // 序号更新(允许回绕)
+    {
+      has_entry = true; // 标记找到记录
+      newest_sequence = entry.sequence; // 记录最新序号
+      newest_slot = slot; // 记录最新槽位
+    }
+  }
+
+  write_slot_ = has_entry ? (newest_slot + 1) % slot_count_ : 0; // 写入位置紧跟最新记录
+  next_sequence_ = has_entry ? newest_sequence + 1 : 0; // 序号继续递增
+  return true; // 初始化成功
+}
+
+bool BatteryEventLog::append(BatteryEventType type, uint64_t timestamp_ms, bool is_epoch_time, float soc_percent, float bus_voltage_v, float current_ma, uint32_t detail)
+{
+  if (partition_ == nullptr) // 分区不可用
+  {
+    return false; // 返回失败
+  }
+
+  if ((write_slot_ % slots_per_sector_) != 0 && !is_slot_blank(write_slot_)) // 槽位被异常写入(如掉电中断),不能直接覆盖
+  {
+    write_slot_ = ((write_slot_ / slots_per_sector_ + 1) * slots_per_sector_) % slot_count_; // 跳到下一个扇区起点
+  }
+  if ((write_slot_ % slots_per_sector_) == 0) // 进入新扇区
+  {
+    if (esp_partition_erase_range(partition_, write_slot_ * sizeof(EventEntry), k_flash_sector_size) != ESP_OK) // 擦除扇区,覆盖最旧的记录
+    {
+      return false; // 擦除失败
+    }
+  }
+
+  EventEntry entry{}; // 新记录
+  entry.sequence = next_sequence_; // 序号
+  entry.timestamp_ms = timestamp_ms; // 时间戳
+  entry.type = static_cast<uint8_t>(type); // 事件类型
+  entry.flags = is_epoch_time ? FLAG_EPOCH_TIME : 0; // 标志位
+  entry.soc_x100 = isnan(soc_percent) ? 0xFFFF : static_cast<uint16_t>(soc_percent * 100.0f + 0.5f); // SOC,无效时全1
+  entry.bus_voltage_mv = isnan(bus_voltage_v) ? 0xFFFF : static_cast<uint16_t>(bus_voltage_v * 1000.0f + 0.5f); // 电压,无效时全1
+  entry.reserved = 0xFFFF; // 保留字段保持擦除值
+  entry.current_ma = isnan(current_ma) ? 0 : static_cast<int32_t>(lroundf(current_ma)); // 电流
+  entry.detail = detail; // 附加信息
+  entry.crc32 = Ina226BatteryMonitor::calc_crc32_le(reinterpret_cast<const uint8_t *>(&entry), offsetof(EventEntry, crc32)); // 计算CRC
+
+  if (esp_partition_write(partition_, write_slot_ * sizeof(EventEntry), &entry, sizeof(entry)) != ESP_OK) // 写入记录
+  {
+    return false; // 写入失败
+  }
+
+  write_slot_ = (write_slot_ + 1) % slot_count_; // 移动写入位置
+  next_sequence_++; // 序号递增
+  return true; // 写入成功
+}
+
+void BatteryEventLog::dump(Print &out) const
+{
+  out.print("seq,timestamp_ms,epoch,event,soc_pct,bus_mv,current_ma,detail\n"); // 输出表头
+  if (partition_ == nullptr) // 分区不可用
+  {
+    return; // 直接返回
+  }
+
+  char line[112]; // 行缓冲
+  for (uint32_t i = 0; i < slot_count_; i++) // 从写入位置开始环形遍历,即从旧到新
+  {
+    EventEntry entry{}; // 记录缓冲
+    if (!read_entry((write_slot_ + i) % slot_count_, entry)) // 空槽或无效记录
+    {
+      continue; // 跳过
+    }
+    snprintf(line, sizeof(line), "%lu,%llu,%u,%s,%u.%02u,%u,%ld,%lu\n", // 格式化一行
+             static_cast<unsigned long>(entry.sequence), // 序号
+             static_cast<unsigned long long>(entry.timestamp_ms), // 时间戳
+             static_cast<unsigned int>(entry.flags & FLAG_EPOCH_TIME), // 是否为Unix时间
+             get_event_type_name(entry.type), // 事件名称
+             static_cast<unsigned int>(entry.soc_x100 / 100), // SOC整数部分
+             static_cast<unsigned int>(entry.soc_x100 % 100), // SOC小数部分
+             static_cast<unsigned int>(entry.bus_voltage_mv), // 电压
+             static_cast<long>(entry.current_ma), // 电流
+             static_cast<unsigned long>(entry.detail)); // 附加信息
+    out.print(line); // 输出
+  }
+}
+
+bool BatteryEventLog::erase()
+{
+  if (partition_ == nullptr) // 分区不可用
+  {
+    return false; // 返回失败
+  }
+
+  write_slot_ = 0; // 从头开始写入
+  next_sequence_ = 0; // 序号归零
+  return esp_partition_erase_range(partition_, 0, partition_->size) == ESP_OK; // 擦除整个分区
+}
+
+const char *BatteryEventLog::get_event_type_name(uint8_t type)
+{
+  if (type >= sizeof(k_event_type_names) / sizeof(k_event_type_names[0])) // 未知类型
+  {
+    return "UNKNOWN"; // 返回未知
+  }
+  return k_event_type_names[type]; // 返回类型名称
+}
+
+bool BatteryEventLog::read_entry(uint32_t slot, EventEntry &out_entry) const
+{
+  if (esp_partition_read(partition_, slot * sizeof(EventEntry), &out_entry, sizeof(out_entry)) != ESP_OK) // 读取记录
+  {
+    return false; // 读取失败
+  }
+  if (out_entry.sequence == k_blank_sequence) // 空槽
+  {
+    return false; // 返回无效
+  }
+  return out_entry.crc32 == Ina226BatteryMonitor::calc_crc32_le(reinterpret_cast<const uint8_t *>(&out_entry), offsetof(EventEntry, crc32)); // 校验CRC
+}
+
+bool BatteryEventLog::is_slot_blank(uint32_t slot) const
+{
+  uint32_t words[sizeof(EventEntry) / sizeof(uint32_t)]; // 槽位内容
+  if (esp_partition_read(partition_, slot * sizeof(EventEntry), words, sizeof(words)) != ESP_OK) // 读取槽位
+  {
+    return false; // 读取失败视为非空
+  }
+  for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) // 检查每个字
+  {
+    if (words[i] != 0xFFFFFFFFu) // 存在已编程的位
+    {
+      return false; // 非空槽
+    }
+  }
+  return true; // 空槽
+}
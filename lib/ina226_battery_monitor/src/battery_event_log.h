@@ -0,0 +1,118 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <esp_partition.h> // 包含ESP32分区读写接口
+
+/**
+ * @brief 电池生命周期事件类型
+ */
+enum class BatteryEventType : uint8_t
+{
+  BOOT, // 上电/复位启动,detail为复位原因
+  BROWNOUT_RESET, // 欠压复位
+  FULL_CHARGE, // 检测到满充
+  DEEP_DISCHARGE, // 剩余容量耗尽
+  SOC_RESET_FROM_VOLTAGE, // 'R'命令按电压重置SOC
+  NVS_CLEARED, // 'C'命令清除NVS并重置
+  NVS_LOAD_FAILED, // NVS状态无效或读取失败
+  NVS_SAVE_FAILED, // NVS保存失败
+  REST_RECALIBRATION, // 静置后按开路电压校准
+  PROTECTION_TRIP, // 保护触发,detail为故障位
+  PROTECTION_CLEAR, // 保护解除
+  EFFICIENCY_LEARNED, // 学习到新的充电效率,detail为效率*10000
+  BOOT_SOC_ARBITRATED, // 启动时NVS与开路电压SOC不一致,detail为开路电压权重*10000
+};
+
+/**
+ * @brief 持久化在Flash环形分区中的电池事件日志
+ * @note 每条记录独立带CRC,写满一个扇区后擦除下一个扇区覆盖最旧的记录
+ */
+class BatteryEventLog
+{
+public:
+  static constexpr uint8_t FLAG_EPOCH_TIME = 0x01; // 时间戳为Unix时间,否则为记录时那次启动的单调时间
+
+  /**
+   * @brief 单条事件记录(32字节,一个扇区恰好容纳整数条)
+   */
+  struct __attribute__((packed)) EventEntry
+  {
+    uint32_t sequence; // 递增序号,全1表示空槽
+    uint64_t timestamp_ms; // 事件时间戳(ms)
+    uint8_t type; // 事件类型(BatteryEventType)
+    uint8_t flags; // 标志位(FLAG_*)
+    uint16_t soc_x100; // SOC * 100
+    uint16_t bus_voltage_mv; // 总线电压(mV)
+    uint16_t reserved; // 保留字段
+    int32_t current_ma; // 电流(mA),放电为正
+    uint32_t detail; // 附加信息,含义由事件类型决定
+    uint32_t crc32; // CRC32校验和
+  };
+
+  /**
+   * @brief 构造函数
+   * @param partition_label 日志所在数据分区的标签
+   */
+  explicit BatteryEventLog(const char *partition_label = "evlog");
+
+  /**
+   * @brief 查找分区并扫描已有记录,定位写入位置
+   * @return true 初始化成功, false 分区不存在或大小不足两个扇区
+   */
+  bool begin();
+
+  /**
+   * @brief 追加一条事件记录
+   * @param type 事件类型
+   * @param timestamp_ms 事件时间戳(ms)
+   * @param is_epoch_time 时间戳是否为Unix时间
+   * @param soc_percent SOC百分比
+   * @param bus_voltage_v 总线电压(V)
+   * @param current_ma 电流(mA)
+   * @param detail 附加信息
+   * @return true 写入成功, false 写入失败
+   */
+  bool append(BatteryEventType type, uint64_t timestamp_ms, bool is_epoch_time, float soc_percent, float bus_voltage_v, float current_ma, uint32_t detail);
+
+  /**
+   * @brief 按从旧到新的顺序以CSV格式输出全部有效记录
+   * @param out 输出对象
+   */
+  void dump(Print &out) const;
+
+  /**
+   * @brief 擦除整个日志分区
+   * @return true 擦除成功, false 擦除失败
+   */
+  bool erase();
+
+  /**
+   * @brief 获取事件类型名称
+   * @param type 事件类型
+   * @return 类型名称字符串
+   */
+  static const char *get_event_type_name(uint8_t type);
+
+private:
+  /**
+   * @brief 读取指定槽位的记录
+   * @param slot 槽位序号
+   * @param out_entry 输出参数,读取到的记录
+   * @return true 读取成功且CRC有效, false 空槽、读取失败或CRC错误
+   */
+  bool read_entry(uint32_t slot, EventEntry &out_entry) const;
+
+  /**
+   * @brief 检查指定槽位是否为擦除后的空槽
+   * @param slot 槽位序号
+   * @return true 空槽, false 非空或读取失败
+   */
+  bool is_slot_blank(uint32_t slot) const;
+
+  const char *partition_label_ = nullptr; // 分区标签
+  const esp_partition_t *partition_ = nullptr; // 分区句柄
+  uint32_t slot_count_ = 0; // 分区可容纳的记录条数
+  uint32_t slots_per_sector_ = 0; // 每个扇区的记录条数
+  uint32_t write_slot_ = 0; // 下一条记录的写入槽位
+  uint32_t next_sequence_ = 0; // 下一条记录的序号
+};
@@ -0,0 +1,242 @@
+#include "burst_scope_capture.h" // 包含高速突发采集的头文件
+
+#include "i2c_bus_arbiter.h" // 包含I2C总线仲裁器
+#include "ina226_timing.h" // 包含INA226转换耗时计算
+#include "sample_text_formatter.h" // 包含定点文本格式化
+
+#include <stdio.h> // 包含标准输入输出库
+
+static constexpr float k_bus_voltage_lsb_v = 1.25e-3f; // INA226总线电压寄存器LSB(V)
+
+BurstScopeCapture::BurstScopeCapture(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.post_trigger_samples == 0) // 至少包含触发样本本身
+  {
+    config_.post_trigger_samples = 1; // 修正为1
+  }
+  if (config_.current_polarity != -1) // 极性只允许1或-1
+  {
+    config_.current_polarity = 1; // 修正为正极性
+  }
+}
+
+bool BurstScopeCapture::begin()
+{
+  is_ready_ = config_.sensor != nullptr && config_.sample_buffer != nullptr && // 传感器与缓冲有效
+              static_cast<uint32_t>(config_.pre_trigger_samples) + config_.post_trigger_samples <= config_.sample_buffer_size; // 触发前后深度不超过容量
+  return is_ready_; // 返回结果
+}
+
+bool BurstScopeCapture::arm()
+{
+  if (!is_ready_) // 未初始化
+  {
+    return false; // 返回失败
+  }
+  if (state_ == State::ARMED || state_ == State::TRIGGERED) // 正在采集
+  {
+    return true; // 保持当前采集
+  }
+
+  bool is_configured = false; // 高速配置是否全部写入
+  {
+    I2cBusLock bus_lock(config_.bus_arbiter, true); // 配置期间占用共享总线
+    if (!bus_lock.is_locked()) // 获取总线失败
+    {
+      return false; // 返回失败
+    }
+    INA226 *sensor = config_.sensor; // 传感器
+    saved_average_ = sensor->getAverage(); // 保存平均点数
+    saved_bus_conversion_time_ = sensor->getBusVoltageConversionTime(); // 保存总线转换时间
+    saved_shunt_conversion_time_ = sensor->getShuntVoltageConversionTime(); // 保存分流转换时间
+    saved_mode_ = sensor->getMode(); // 保存工作模式
+    current_lsb_ma_ = sensor->getCurrentLSB_mA(); // 当前校准下的电流LSB
+    is_configured = sensor->setAverage(INA226_1_SAMPLE) && // 不平均
+                    sensor->setBusVoltageConversionTime(INA226_140_us) && // 最短总线转换时间
+                    sensor->setShuntVoltageConversionTime(INA226_140_us) && // 最短分流转换时间
+                    sensor->setModeShuntBusContinuous(); // 连续转换
+    if (is_configured) // 配置成功
+    {
+      sensor->isConversionReady(); // 读取Mask/Enable寄存器,清除旧配置下残留的就绪标志
+    }
+  }
+  if (!is_configured) // 部分写入失败
+  {
+    restore_sensor_config(); // 恢复已改写的配置,不留下半高速状态
+    return false; // 配置失败
+  }
+  conversion_timeout_ms_ = get_ina226_conversion_timeout_ms(2 * get_ina226_conversion_us(INA226_1_SAMPLE, INA226_140_us)); // 分流与总线各转换一次
+
+  const float raw_current = current_lsb_ma_ > 0.0f ? config_.trigger_current_ma / current_lsb_ma_ : 32767.0f; // 电流阈值换算为LSB
+  raw_trigger_current_ = static_cast<int16_t>(raw_current > 32767.0f ? 32767.0f : (raw_current < 0.0f ? 0.0f : raw_current)); // 限制在寄存器范围内
+  raw_trigger_voltage_ = static_cast<uint16_t>(config_.trigger_voltage_v / k_bus_voltage_lsb_v); // 电压阈值换算为LSB
+
+  write_index_ = 0; // 从头写入
+  filled_count_ = 0; // 清空计数
+  captured_count_ = 0; // 清空冻结波形
+  trigger_index_ = 0; // 清空触发位置
+  state_ = State::ARMED; // 进入等待触发
+  return true; // 启动成功
+}
+
+bool BurstScopeCapture::run(uint32_t timeout_ms)
+{
+  const uint32_t start_ms = millis(); // 记录开始时间
+  while (state_ == State::ARMED || state_ == State::TRIGGERED) // 采集中
+  {
+    if (!capture_sample()) // 读取失败
+    {
+      return false; // 返回失败
+    }
+    if (state_ == State::ARMED && (millis() - start_ms) >= timeout_ms) // 等待触发超时;已触发时总是采完触发后样本
+    {
+      return false; // 保持ARMED,可再次调用
+    }
+  }
+  return state_ == State::FROZEN; // 返回是否已冻结
+}
+
+void BurstScopeCapture::stop()
+{
+  if (state_ == State::ARMED || state_ == State::TRIGGERED) // 正在采集
+  {
+    restore_sensor_config(); // 恢复传感器配置
+    state_ = State::IDLE; // 回到未启动
+  }
+}
+
+BurstScopeCapture::State BurstScopeCapture::get_state() const
+{
+  return state_; // 返回采集状态
+}
+
+uint16_t BurstScopeCapture::get_captured_count() const
+{
+  return captured_count_; // 返回冻结波形的样本数
+}
+
+uint16_t BurstScopeCapture::get_trigger_index() const
+{
+  return trigger_index_; // 返回触发样本序号
+}
+
+uint16_t BurstScopeCapture::read_samples(uint16_t first, ScopeSample *out_samples, uint16_t count) const
+{
+  if (state_ != State::FROZEN || out_samples == nullptr || first >= captured_count_) // 未冻结或参数无效
+  {
+    return 0; // 不读取
+  }
+  const uint16_t available = captured_count_ - first; // 可读取的样本数
+  const uint16_t read_count = count < available ? count : available; // 实际读取数
+  for (uint16_t i = 0; i < read_count; i++) // 按时间顺序复制
+  {
+    out_samples[i] = config_.sample_buffer[to_buffer_index(first + i)]; // 复制样本
+  }
+  return read_count; // 返回读取数
+}
+
+void BurstScopeCapture::dump(Print &out) const
+{
+  out.print("offset_us,current_ma,bus_v\n"); // 输出表头
+  if (state_ != State::FROZEN) // 未冻结
+  {
+    return; // 只输出表头
+  }
+
+  const uint32_t trigger_us = config_.sample_buffer[to_buffer_index(trigger_index_)].time_us; // 触发样本时刻
+  char line[48]; // 行缓冲
+  for (uint16_t i = 0; i < captured_count_; i++) // 按时间顺序输出
+  {
+    const ScopeSample &sample = config_.sample_buffer[to_buffer_index(i)]; // 当前样本
+    const float current_ma = static_cast<float>(config_.current_polarity) * static_cast<float>(sample.raw_current) * current_lsb_ma_; // 换算电流
+    const float bus_voltage_v = static_cast<float>(sample.raw_bus_voltage) * k_bus_voltage_lsb_v; // 换算电压
+    snprintf(line, sizeof(line), "%ld,%s,%s\n", // 格式化一行
+             static_cast<long>(static_cast<int32_t>(sample.time_us - trigger_us)), // 相对触发的偏移
+             FixedPointText(current_ma, 3).c_str(), // 电流
+             FixedPointText(bus_voltage_v, 4).c_str()); // 电压
+    out.print(line); // 输出
+  }
+}
+
+bool BurstScopeCapture::capture_sample()
+{
+  ScopeSample &sample = config_.sample_buffer[write_index_]; // 写入位置
+  const uint32_t wait_start_ms = millis(); // 等待起点
+  bool is_ready = false; // 是否有新的转换结果
+  while (!is_ready) // 总线较快时两次读取可能落在同一次转换内,必须等到新的转换完成
+  {
+    {
+      I2cBusLock bus_lock(config_.bus_arbiter, true); // 每次轮询单独占用总线,其他设备可在轮询之间插入
+      if (!bus_lock.is_locked()) // 获取总线超时
+      {
+        return false; // 返回失败
+      }
+      is_ready = config_.sensor->isConversionReady(); // 读取Mask/Enable寄存器的CVRF,同时清除
+      if (is_ready) // 新的转换已完成
+      {
+        sample.time_us = micros(); // 记录转换完成的时刻
+        sample.raw_current = static_cast<int16_t>(config_.sensor->getRegister(INA226_CURRENT)); // 读取电流寄存器
+        sample.raw_bus_voltage = config_.sensor->getRegister(INA226_BUS_VOLTAGE); // 读取总线电压寄存器
+      }
+    }
+    if (!is_ready && (millis() - wait_start_ms) >= conversion_timeout_ms_) // 转换超时
+    {
+      return false; // 返回失败
+    }
+  }
+
+  write_index_ = (write_index_ + 1) % config_.sample_buffer_size; // 环形前进
+  filled_count_++; // 累计写入数
+
+  if (state_ == State::ARMED) // 等待触发
+  {
+    if (filled_count_ > config_.pre_trigger_samples && is_trigger_sample(sample)) // 触发前深度已填满且满足条件
+    {
+      state_ = State::TRIGGERED; // 进入触发后采集
+      remaining_post_samples_ = config_.post_trigger_samples - 1; // 触发样本已计入
+    }
+  }
+  else if (remaining_post_samples_ > 0) // 触发后采集
+  {
+    remaining_post_samples_--; // 计数
+  }
+
+  if (state_ == State::TRIGGERED && remaining_post_samples_ == 0) // 触发后样本采集完成
+  {
+    captured_count_ = config_.pre_trigger_samples + config_.post_trigger_samples; // 冻结深度
+    trigger_index_ = config_.pre_trigger_samples; // 触发样本位置
+    state_ = State::FROZEN; // 冻结缓冲
+    restore_sensor_config(); // 恢复传感器配置
+  }
+  return true; // 读取成功
+}
+
+bool BurstScopeCapture::is_trigger_sample(const ScopeSample &sample) const
+{
+  if (config_.trigger_source == TriggerSource::VOLTAGE_BELOW) // 掉电触发
+  {
+    return sample.raw_bus_voltage < raw_trigger_voltage_; // 电压低于阈值
+  }
+  const int32_t abs_current = sample.raw_current < 0 ? -static_cast<int32_t>(sample.raw_current) : sample.raw_current; // 电流绝对值(LSB)
+  return abs_current > raw_trigger_current_; // 电流超过阈值
+}
+
+void BurstScopeCapture::restore_sensor_config()
+{
+  I2cBusLock bus_lock(config_.bus_arbiter, true); // 配置期间占用共享总线
+  if (!bus_lock.is_locked()) // 获取总线失败
+  {
+    return; // 无法恢复,保持高速配置
+  }
+  config_.sensor->setAverage(saved_average_); // 恢复平均点数
+  config_.sensor->setBusVoltageConversionTime(saved_bus_conversion_time_); // 恢复总线转换时间
+  config_.sensor->setShuntVoltageConversionTime(saved_shunt_conversion_time_); // 恢复分流转换时间
+  config_.sensor->setMode(saved_mode_); // 恢复工作模式
+}
+
+uint16_t BurstScopeCapture::to_buffer_index(uint16_t index) const
+{
+  const uint32_t oldest = (static_cast<uint32_t>(write_index_) + config_.sample_buffer_size - captured_count_) % config_.sample_buffer_size; // 最早样本的下标
+  return static_cast<uint16_t>((oldest + index) % config_.sample_buffer_size); // 换算下标
+}
@@ -0,0 +1,173 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <INA226.h> // 包含INA226驱动库
+
+class I2cBusArbiter; // I2C总线仲裁器(前置声明)
+
+/**
+ * @brief 高速突发采集("示波器模式"),用于诊断浪涌电流与掉电
+ * @note 将INA226设为最短转换时间、不平均的连续转换,每次转换完成(CVRF置位)时把原始寄存器值写入环形缓冲;
+ *       满足触发条件后再采集配置的触发后样本数并冻结,之后可整体导出波形
+ * @note 传感器由本类独占,arm()会改写其配置,冻结或停止后恢复原配置
+ */
+class BurstScopeCapture
+{
+public:
+  /**
+   * @brief 触发条件
+   */
+  enum class TriggerSource : uint8_t
+  {
+    CURRENT_ABOVE, // 电流绝对值超过阈值(浪涌)
+    VOLTAGE_BELOW, // 总线电压低于阈值(掉电)
+  };
+
+  /**
+   * @brief 采集状态
+   */
+  enum class State : uint8_t
+  {
+    IDLE, // 未启动
+    ARMED, // 正在采集,等待触发
+    TRIGGERED, // 已触发,正在采集触发后样本
+    FROZEN, // 采集完成,缓冲已冻结
+  };
+
+  /**
+   * @brief 单个原始样本
+   * @note 保存寄存器原始值以压缩缓冲占用,导出时再换算
+   */
+  struct ScopeSample
+  {
+    uint32_t time_us = 0; // 检测到转换完成的时刻(micros()),每个样本对应一次新的转换
+    int16_t raw_current = 0; // 电流寄存器原始值
+    uint16_t raw_bus_voltage = 0; // 总线电压寄存器原始值(LSB 1.25mV)
+  };
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    INA226 *sensor = nullptr; // 采集用的INA226,需由调用者完成校准(setMaxCurrentShunt)
+    ScopeSample *sample_buffer = nullptr; // 调用者提供的环形缓冲
+    uint16_t sample_buffer_size = 0; // 缓冲容量(样本数)
+    uint16_t pre_trigger_samples = 0; // 触发前保留的样本数
+    uint16_t post_trigger_samples = 0; // 触发后采集的样本数(含触发样本),与触发前之和不超过缓冲容量
+    TriggerSource trigger_source = TriggerSource::CURRENT_ABOVE; // 触发条件
+    float trigger_current_ma = 0.0f; // 电流触发阈值(mA),比较绝对值
+    float trigger_voltage_v = 0.0f; // 电压触发阈值(V)
+    int8_t current_polarity = 1; // 电流极性(1 或 -1),仅影响导出
+    I2cBusArbiter *bus_arbiter = nullptr; // 共享I2C总线仲裁器,nullptr表示独占总线
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit BurstScopeCapture(const Config &config);
+
+  /**
+   * @brief 检查配置
+   * @return true 配置有效, false 缓冲为空、深度超出容量或传感器为空
+   */
+  bool begin();
+
+  /**
+   * @brief 切换传感器到高速模式并开始采集
+   * @return true 成功, false 未初始化或传感器配置失败
+   * @note 配置写入失败时恢复原配置
+   */
+  bool arm();
+
+  /**
+   * @brief 逐次转换连续采集,直到冻结或超时
+   * @param timeout_ms 最长采集时间(ms),超时仍未触发时保持ARMED,可再次调用继续
+   * @return true 已冻结, false 超时或读取失败
+   * @note 阻塞调用;每个样本单独以高优先级占用总线,其他设备可在样本之间插入
+   */
+  bool run(uint32_t timeout_ms);
+
+  /**
+   * @brief 停止采集并恢复传感器配置
+   */
+  void stop();
+
+  /**
+   * @brief 获取采集状态
+   * @return 当前状态
+   */
+  State get_state() const;
+
+  /**
+   * @brief 获取冻结波形的样本数
+   * @return 样本数,未冻结时为0
+   */
+  uint16_t get_captured_count() const;
+
+  /**
+   * @brief 获取触发样本在冻结波形中的序号
+   * @return 触发样本序号(从0开始)
+   */
+  uint16_t get_trigger_index() const;
+
+  /**
+   * @brief 按时间顺序批量读取冻结波形
+   * @param first 起始序号(0为最早的样本)
+   * @param out_samples 输出缓冲
+   * @param count 最多读取的样本数
+   * @return 实际读取的样本数
+   */
+  uint16_t read_samples(uint16_t first, ScopeSample *out_samples, uint16_t count) const;
+
+  /**
+   * @brief 以CSV格式导出冻结波形
+   * @param out 输出对象(如Serial)
+   * @note 时间为相对触发样本的偏移(us),电流与电压按校准换算
+   */
+  void dump(Print &out) const;
+
+private:
+  /**
+   * @brief 等待一次新的转换完成,读取样本写入环形缓冲并判断触发
+   * @return true 读取成功, false 获取总线失败或转换超时
+   */
+  bool capture_sample();
+
+  /**
+   * @brief 判断样本是否满足触发条件
+   * @param sample 样本
+   * @return true 满足, false 不满足
+   */
+  bool is_trigger_sample(const ScopeSample &sample) const;
+
+  /**
+   * @brief 恢复arm()之前的传感器配置
+   */
+  void restore_sensor_config();
+
+  /**
+   * @brief 将冻结波形的序号换算为缓冲下标
+   * @param index 冻结波形中的序号
+   * @return 缓冲下标
+   */
+  uint16_t to_buffer_index(uint16_t index) const;
+
+  Config config_{}; // 配置副本
+  bool is_ready_ = false; // 是否已成功初始化
+  State state_ = State::IDLE; // 采集状态
+  uint16_t write_index_ = 0; // 下一个写入位置
+  uint32_t filled_count_ = 0; // 启动后已写入的样本数
+  uint16_t remaining_post_samples_ = 0; // 触发后还需采集的样本数
+  uint16_t captured_count_ = 0; // 冻结波形的样本数
+  uint16_t trigger_index_ = 0; // 触发样本在冻结波形中的序号
+  int16_t raw_trigger_current_ = 0; // 电流触发阈值(LSB)
+  uint16_t raw_trigger_voltage_ = 0; // 电压触发阈值(LSB)
+  float current_lsb_ma_ = 0.0f; // 电流寄存器LSB(mA)
+  uint8_t saved_average_ = 0; // arm()前的平均点数
+  uint8_t saved_bus_conversion_time_ = 0; // arm()前的总线转换时间
+  uint8_t saved_shunt_conversion_time_ = 0; // arm()前的分流转换时间
+  uint8_t saved_mode_ = 0; // arm()前的工作模式
+  uint32_t conversion_timeout_ms_ = 0; // 等待单次转换完成的超时时间(ms)
+};
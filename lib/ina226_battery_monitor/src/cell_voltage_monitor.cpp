@@ -0,0 +1,240 @@
+#include "cell_voltage_monitor.h" // 包含单节电压监视器的头文件
+
+#include "ina226_timing.h" // 包含INA226转换耗时计算
+
+CellVoltageMonitor::CellVoltageMonitor(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.cell_count > MAX_CELLS) // 节数超出上限
+  {
+    config_.cell_count = MAX_CELLS; // 限制为上限
+  }
+}
+
+bool CellVoltageMonitor::begin()
+{
+  if (config_.cell_count == 0) // 未配置节数
+  {
+    return false; // 返回失败
+  }
+
+  if (config_.scan_mode == ScanMode::ANALOG_MUX) // 模拟开关模式
+  {
+    if (config_.mux_sensor == nullptr || !config_.mux_sensor->begin()) // 检查传感器
+    {
+      return false; // 返回失败
+    }
+    for (uint8_t i = 0; i < MUX_SELECT_PIN_COUNT; i++) // 初始化地址线
+    {
+      if (config_.mux_select_pins[i] >= 0) // 引脚有效
+      {
+        pinMode(config_.mux_select_pins[i], OUTPUT); // 设置为输出
+      }
+    }
+    config_.mux_sensor->setModeBusTrigger(); // 切换为单次触发的总线电压转换,避免读到切换前的数据
+    const uint32_t expected_us = get_ina226_conversion_us(config_.mux_sensor->getAverage(), config_.mux_sensor->getBusVoltageConversionTime()); // 按当前设置的预计转换耗时
+    tap_conversion_timeout_ms_ = get_ina226_conversion_timeout_ms(expected_us); // 高平均点数时可达数秒
+    return true; // 初始化成功
+  }
+
+  for (uint8_t i = 0; i < config_.cell_count; i++) // 检查每个抽头传感器
+  {
+    if (config_.tap_sensors[i] == nullptr || !config_.tap_sensors[i]->begin()) // 传感器为空或无响应
+    {
+      return false; // 返回失败
+    }
+  }
+  return true; // 初始化成功
+}
+
+bool CellVoltageMonitor::update(uint32_t now_ms)
+{
+  if (config_.cell_count == 0) // 未配置节数
+  {
+    return false; // 不扫描
+  }
+
+  if (!is_scan_in_progress_) // 没有进行中的扫描
+  {
+    if (is_scan_valid_ && (now_ms - last_scan_ms_) < config_.scan_interval_ms) // 未到扫描周期
+    {
+      return false; // 不扫描
+    }
+    last_scan_ms_ = now_ms; // 记录扫描开始时间
+    is_scan_in_progress_ = true; // 开始新一轮扫描
+    next_tap_index_ = 0; // 从最低抽头开始
+    is_tap_conversion_pending_ = false; // 尚未触发转换
+  }
+  return step_scan(now_ms); // 推进一个抽头
+}
+
+bool CellVoltageMonitor::step_scan(uint32_t now_ms)
+{
+  float tap_v = 0.0f; // 抽头电压
+  if (config_.scan_mode == ScanMode::ANALOG_MUX) // 模拟开关模式:触发与读取分在两次调用中
+  {
+    if (!is_tap_conversion_pending_) // 尚未触发本抽头的转换
+    {
+      if (!start_tap_conversion(next_tap_index_)) // 触发失败
+      {
+        is_scan_in_progress_ = false; // 放弃本轮扫描
+        is_scan_valid_ = false; // 标记结果无效
+        return false; // 返回失败
+      }
+      is_tap_conversion_pending_ = true; // 等待转换完成
+      tap_trigger_ms_ = now_ms; // 记录触发时间
+      return false; // 下次调用再读取
+    }
+    if (!config_.mux_sensor->isConversionReady()) // 转换未完成
+    {
+      if ((now_ms - tap_trigger_ms_) >= tap_conversion_timeout_ms_) // 超时
+      {
+        is_tap_conversion_pending_ = false; // 清除等待状态
+        is_scan_in_progress_ = false; // 放弃本轮扫描
+        is_scan_valid_ = false; // 标记结果无效
+      }
+      return false; // 继续等待或返回失败
+    }
+    is_tap_conversion_pending_ = false; // 转换已完成
+    tap_v = config_.mux_sensor->getBusVoltage() * config_.tap_voltage_scale; // 读取并修正抽头电压
+  }
+  else if (!read_tap_voltage(next_tap_index_, tap_v)) // 每个抽头一个传感器,直接读取
+  {
+    is_scan_in_progress_ = false; // 放弃本轮扫描
+    is_scan_valid_ = false; // 标记结果无效
+    return false; // 返回失败
+  }
+
+  scan_tap_voltages_v_[next_tap_index_] = tap_v; // 保存抽头电压
+  next_tap_index_++; // 下一个抽头
+  if (next_tap_index_ < config_.cell_count) // 本轮未完成
+  {
+    return false; // 下次调用继续
+  }
+  is_scan_in_progress_ = false; // 本轮完成
+  apply_scan(scan_tap_voltages_v_); // 更新统计
+  return true; // 扫描成功
+}
+
+bool CellVoltageMonitor::scan()
+{
+  if (config_.cell_count == 0) // 未配置节数
+  {
+    return false; // 返回失败
+  }
+
+  is_scan_in_progress_ = false; // 放弃进行中的分步扫描
+  is_tap_conversion_pending_ = false; // 清除等待状态
+  for (uint8_t i = 0; i < config_.cell_count; i++) // 逐个读取抽头
+  {
+    if (!read_tap_voltage(i, scan_tap_voltages_v_[i])) // 读取失败
+    {
+      is_scan_valid_ = false; // 标记结果无效
+      return false; // 返回失败
+    }
+  }
+  apply_scan(scan_tap_voltages_v_); // 更新统计
+  return true; // 扫描成功
+}
+
+void CellVoltageMonitor::apply_scan(const float *tap_voltages_v)
+{
+  float previous_tap_v = 0.0f; // 上一个抽头电压
+  float min_v = INFINITY; // 最低单节电压
+  float max_v = -INFINITY; // 最高单节电压
+  uint8_t weakest_index = 0; // 最低单节序号
+  for (uint8_t i = 0; i < config_.cell_count; i++) // 逐个换算单节电压
+  {
+    const float tap_v = tap_voltages_v[i]; // 抽头电压
+    const float cell_v = config_.is_tap_voltage_cumulative ? (tap_v - previous_tap_v) : tap_v; // 累计电压需减去下一级抽头
+    previous_tap_v = tap_v; // 记录本抽头电压
+    cell_voltages_v_[i] = cell_v; // 保存单节电压
+    if (cell_v < min_v) // 更新最低值
+    {
+      min_v = cell_v; // 最低电压
+      weakest_index = i; // 最弱单节
+    }
+    if (cell_v > max_v) // 更新最高值
+    {
+      max_v = cell_v; // 最高电压
+    }
+  }
+
+  min_cell_voltage_v_ = min_v; // 保存最低单节电压
+  max_cell_voltage_v_ = max_v; // 保存最高单节电压
+  weakest_cell_index_ = weakest_index; // 保存最弱单节序号
+  is_scan_valid_ = true; // 标记结果有效
+}
+
+bool CellVoltageMonitor::has_valid_scan() const
+{
+  return is_scan_valid_; // 返回扫描结果是否有效
+}
+
+uint8_t CellVoltageMonitor::get_cell_count() const
+{
+  return config_.cell_count; // 返回串联节数
+}
+
+float CellVoltageMonitor::get_cell_voltage_v(uint8_t cell_index) const
+{
+  if (!is_scan_valid_ || cell_index >= config_.cell_count) // 结果无效或序号越界
+  {
+    return NAN; // 返回无效值
+  }
+  return cell_voltages_v_[cell_index]; // 返回单节电压
+}
+
+float CellVoltageMonitor::get_min_cell_voltage_v() const
+{
+  return is_scan_valid_ ? min_cell_voltage_v_ : NAN; // 返回最低单节电压
+}
+
+float CellVoltageMonitor::get_max_cell_voltage_v() const
+{
+  return is_scan_valid_ ? max_cell_voltage_v_ : NAN; // 返回最高单节电压
+}
+
+float CellVoltageMonitor::get_imbalance_mv() const
+{
+  return is_scan_valid_ ? (max_cell_voltage_v_ - min_cell_voltage_v_) * 1000.0f : NAN; // 返回单节压差(mV)
+}
+
+uint8_t CellVoltageMonitor::get_weakest_cell_index() const
+{
+  return weakest_cell_index_; // 返回最弱单节序号
+}
+
+bool CellVoltageMonitor::read_tap_voltage(uint8_t tap_index, float &out_tap_voltage_v)
+{
+  if (config_.scan_mode == ScanMode::ANALOG_MUX) // 模拟开关模式
+  {
+    if (!start_tap_conversion(tap_index) || !config_.mux_sensor->waitConversionReady(tap_conversion_timeout_ms_)) // 触发并等待转换完成
+    {
+      return false; // 触发失败或超时返回失败
+    }
+    out_tap_voltage_v = config_.mux_sensor->getBusVoltage() * config_.tap_voltage_scale; // 读取并修正抽头电压
+    return true; // 读取成功
+  }
+
+  out_tap_voltage_v = config_.tap_sensors[tap_index]->getBusVoltage() * config_.tap_voltage_scale; // 读取并修正抽头电压
+  return true; // 读取成功
+}
+
+bool CellVoltageMonitor::start_tap_conversion(uint8_t tap_index)
+{
+  select_mux_channel(tap_index); // 切换到目标抽头
+  delayMicroseconds(config_.mux_settle_us); // 等待模拟开关与输入滤波稳定
+  return config_.mux_sensor->setModeBusTrigger(); // 触发一次新的总线电压转换(同时清除转换就绪标志)
+}
+
+void CellVoltageMonitor::select_mux_channel(uint8_t channel)
+{
+  for (uint8_t i = 0; i < MUX_SELECT_PIN_COUNT; i++) // 逐位输出通道地址
+  {
+    if (config_.mux_select_pins[i] >= 0) // 引脚有效
+    {
+      digitalWrite(config_.mux_select_pins[i], (channel >> i) & 0x01 ? HIGH : LOW); // 输出对应地址位
+    }
+  }
+}
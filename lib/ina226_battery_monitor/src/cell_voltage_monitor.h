@@ -0,0 +1,164 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <INA226.h> // 包含INA226驱动库
+
+#include <math.h> // 包含数学库
+
+/**
+ * @brief 单节电压监视器类
+ * @note 支持两种接法: 每个抽头一个INA226(总线输入接抽头),或一个INA226的总线输入经模拟开关轮流接到各抽头
+ * @note 按扫描周期调度,update()每次只推进一个抽头,避免整轮扫描长时间占用共享总线
+ */
+class CellVoltageMonitor
+{
+public:
+  static constexpr uint8_t MAX_CELLS = 8; // 支持的最大串联节数
+  static constexpr uint8_t MUX_SELECT_PIN_COUNT = 3; // 模拟开关地址线数量(最多8路)
+
+  /**
+   * @brief 扫描方式
+   */
+  enum class ScanMode : uint8_t
+  {
+    MULTI_INA226, // 每个抽头一个INA226
+    ANALOG_MUX, // 单个INA226经模拟开关轮询各抽头
+  };
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    ScanMode scan_mode = ScanMode::MULTI_INA226; // 扫描方式
+    uint8_t cell_count = 0; // 串联节数(1-MAX_CELLS)
+    INA226 *tap_sensors[MAX_CELLS] = {}; // MULTI_INA226模式下各抽头对应的INA226,按从低到高排列
+    INA226 *mux_sensor = nullptr; // ANALOG_MUX模式下总线输入接模拟开关公共端的INA226
+    int mux_select_pins[MUX_SELECT_PIN_COUNT] = {-1, -1, -1}; // 模拟开关地址线引脚,-1表示未使用
+    uint32_t mux_settle_us = 200; // 切换模拟开关后的稳定时间(us)
+    bool is_tap_voltage_cumulative = true; // 抽头电压是否为对地累计电压(需相减得到单节电压)
+    float tap_voltage_scale = 1.0f; // 抽头电压修正系数(外部分压比)
+    uint32_t scan_interval_ms = 1000; // 扫描周期(ms)
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit CellVoltageMonitor(const Config &config);
+
+  /**
+   * @brief 初始化单节电压监视器
+   * @return true 初始化成功, false 配置无效或传感器无响应
+   * @note 需要在I2C总线初始化之后调用;ANALOG_MUX模式按传感器当前的平均点数与总线转换时间计算转换超时,修改这两项后需重新调用
+   */
+  bool begin();
+
+  /**
+   * @brief 按扫描周期调度扫描,每次调用只读取一个抽头
+   * @param now_ms 当前系统时间戳(ms)
+   * @return true 本次完成了一次新的扫描, false 未到扫描周期、扫描未完成或扫描失败
+   * @note ANALOG_MUX模式下一次调用触发转换,之后的调用查询转换是否完成,不在调用内等待
+   */
+  bool update(uint32_t now_ms);
+
+  /**
+   * @brief 立即扫描全部抽头并更新统计
+   * @return true 扫描成功, false 扫描失败
+   * @note 在调用内等待每个抽头的转换,用于初始化;进行中的分步扫描被放弃
+   */
+  bool scan();
+
+  /**
+   * @brief 是否已有有效的扫描结果
+   * @return true 有效, false 尚未扫描成功
+   */
+  bool has_valid_scan() const;
+
+  /**
+   * @brief 获取串联节数
+   * @return 串联节数
+   */
+  uint8_t get_cell_count() const;
+
+  /**
+   * @brief 获取指定单节电压
+   * @param cell_index 单节序号(从0开始,0为最低端)
+   * @return 单节电压(V),无效时返回NAN
+   */
+  float get_cell_voltage_v(uint8_t cell_index) const;
+
+  /**
+   * @brief 获取最低单节电压
+   * @return 最低单节电压(V)
+   */
+  float get_min_cell_voltage_v() const;
+
+  /**
+   * @brief 获取最高单节电压
+   * @return 最高单节电压(V)
+   */
+  float get_max_cell_voltage_v() const;
+
+  /**
+   * @brief 获取单节压差(最高-最低)
+   * @return 压差(mV)
+   */
+  float get_imbalance_mv() const;
+
+  /**
+   * @brief 获取最弱(电压最低)单节的序号
+   * @return 单节序号
+   */
+  uint8_t get_weakest_cell_index() const;
+
+private:
+  /**
+   * @brief 推进分步扫描一步
+   * @param now_ms 当前系统时间戳(ms)
+   * @return true 本步完成了整轮扫描, false 扫描未完成或失败
+   */
+  bool step_scan(uint32_t now_ms);
+
+  /**
+   * @brief 读取指定抽头的电压,ANALOG_MUX模式下在调用内等待转换完成
+   * @param tap_index 抽头序号
+   * @param out_tap_voltage_v 输出参数,抽头电压(V)
+   * @return true 读取成功, false 读取失败
+   */
+  bool read_tap_voltage(uint8_t tap_index, float &out_tap_voltage_v);
+
+  /**
+   * @brief ANALOG_MUX模式下切换到指定抽头并触发一次总线电压转换
+   * @param tap_index 抽头序号
+   * @return true 触发成功, false 写配置寄存器失败
+   */
+  bool start_tap_conversion(uint8_t tap_index);
+
+  /**
+   * @brief 由一轮扫描的抽头电压计算单节电压与统计
+   * @param tap_voltages_v 各抽头电压(V)
+   */
+  void apply_scan(const float *tap_voltages_v);
+
+  /**
+   * @brief 切换模拟开关到指定通道
+   * @param channel 通道号
+   */
+  void select_mux_channel(uint8_t channel);
+
+  Config config_{}; // 配置副本
+
+  bool is_scan_valid_ = false; // 是否已有有效扫描结果
+  uint32_t last_scan_ms_ = 0; // 上次扫描开始的时间戳
+  bool is_scan_in_progress_ = false; // 是否有进行中的分步扫描
+  uint8_t next_tap_index_ = 0; // 分步扫描的下一个抽头
+  bool is_tap_conversion_pending_ = false; // ANALOG_MUX模式下是否有已触发、未读取的转换
+  uint32_t tap_trigger_ms_ = 0; // 触发转换的时间戳
+  uint32_t tap_conversion_timeout_ms_ = 0; // 单次抽头转换的超时时间(ms),begin()中按传感器设置计算
+  float scan_tap_voltages_v_[MAX_CELLS] = {}; // 进行中扫描已读取的抽头电压(V),整轮完成后才更新统计
+  float cell_voltages_v_[MAX_CELLS] = {}; // 各单节电压(V)
+  float min_cell_voltage_v_ = NAN; // 最低单节电压(V)
+  float max_cell_voltage_v_ = NAN; // 最高单节电压(V)
+  uint8_t weakest_cell_index_ = 0; // 最低单节序号
+};
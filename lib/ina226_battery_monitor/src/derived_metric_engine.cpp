@@ -0,0 +1,155 @@
+#include "derived_metric_engine.h" // 包含派生通道计算的头文件
+
+#include <math.h> // 包含数学库
+
+uint8_t DerivedMetricEngine::sensor_input(uint8_t channel, Quantity quantity)
+{
+  if (channel >= Ina226SyncGroup::MAX_CHANNELS || static_cast<uint8_t>(quantity) >= QUANTITY_COUNT) // 越界时会落到其他测量量的位置
+  {
+    return INVALID_INPUT; // 返回无效序号
+  }
+  return static_cast<uint8_t>(static_cast<uint8_t>(quantity) * Ina226SyncGroup::MAX_CHANNELS + channel); // 按测量量分组排列
+}
+
+uint8_t DerivedMetricEngine::derived_input(uint8_t derived_index)
+{
+  return static_cast<uint8_t>(SENSOR_INPUT_COUNT + derived_index); // 派生结果排在传感器输入之后
+}
+
+DerivedMetricEngine::ChannelDefinition DerivedMetricEngine::make_sum(uint8_t input_a, uint8_t input_b, float scale)
+{
+  ChannelDefinition definition{}; // 通道定义
+  definition.input_a = input_a; // 操作数a
+  definition.input_b = input_b; // 操作数b
+  definition.na = scale; // a的系数
+  definition.nb = scale; // b的系数
+  return definition; // 返回定义
+}
+
+DerivedMetricEngine::ChannelDefinition DerivedMetricEngine::make_difference(uint8_t input_a, uint8_t input_b, float scale)
+{
+  ChannelDefinition definition{}; // 通道定义
+  definition.input_a = input_a; // 操作数a
+  definition.input_b = input_b; // 操作数b
+  definition.na = scale; // a的系数
+  definition.nb = -scale; // b的系数
+  return definition; // 返回定义
+}
+
+DerivedMetricEngine::ChannelDefinition DerivedMetricEngine::make_product(uint8_t input_a, uint8_t input_b, float scale)
+{
+  ChannelDefinition definition{}; // 通道定义
+  definition.input_a = input_a; // 操作数a
+  definition.input_b = input_b; // 操作数b
+  definition.nab = scale; // a*b的系数
+  return definition; // 返回定义
+}
+
+DerivedMetricEngine::ChannelDefinition DerivedMetricEngine::make_ratio(uint8_t input_a, uint8_t input_b, float scale, float min_denominator)
+{
+  ChannelDefinition definition{}; // 通道定义
+  definition.input_a = input_a; // 操作数a
+  definition.input_b = input_b; // 操作数b
+  definition.na = scale; // 分子为scale*a
+  definition.d0 = 0.0f; // 分母无常数项
+  definition.db = 1.0f; // 分母为b
+  definition.min_denominator = min_denominator; // 分母过小时无意义
+  return definition; // 返回定义
+}
+
+DerivedMetricEngine::DerivedMetricEngine(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.channel_count > MAX_DERIVED_CHANNELS) // 通道数超出上限
+  {
+    config_.channel_count = MAX_DERIVED_CHANNELS; // 限制为上限
+  }
+}
+
+bool DerivedMetricEngine::begin()
+{
+  is_ready_ = false; // 先标记未就绪
+  if (config_.channel_count == 0) // 未配置通道
+  {
+    return false; // 返回失败
+  }
+  for (uint8_t i = 0; i < config_.channel_count; i++) // 检查每个通道
+  {
+    const ChannelDefinition &definition = config_.channels[i]; // 通道定义
+    const uint8_t limit = derived_input(i); // 只能引用传感器输入与已计算的派生通道
+    if (definition.input_a >= limit || definition.input_b >= limit) // 越界或引用未计算的通道
+    {
+      return false; // 返回失败
+    }
+    integration_weights_[i] = definition.is_integrated ? 1.0f : 0.0f; // 预计算积分权重
+    previous_values_[i] = 0.0f; // 首帧不积分,值在首帧写入
+  }
+  reset_integrals(); // 清零积分
+  has_last_frame_ = false; // 重新开始计时
+  is_ready_ = true; // 标记就绪
+  return true; // 初始化成功
+}
+
+void DerivedMetricEngine::update(const Ina226SyncGroup::Frame &frame)
+{
+  if (!is_ready_) // 未初始化
+  {
+    return; // 不计算
+  }
+
+  for (uint8_t i = 0; i < Ina226SyncGroup::MAX_CHANNELS; i++) // 展开为连续的操作数空间,未使用的通道为0
+  {
+    const bool is_used = i < frame.channel_count; // 通道是否有效
+    inputs_[sensor_input(i, Quantity::BUS_VOLTAGE_V)] = is_used ? frame.bus_voltage_v[i] : 0.0f; // 总线电压
+    inputs_[sensor_input(i, Quantity::SHUNT_VOLTAGE_MV)] = is_used ? frame.shunt_voltage_mv[i] : 0.0f; // 分流电压
+    inputs_[sensor_input(i, Quantity::CURRENT_MA)] = is_used ? frame.current_ma[i] : 0.0f; // 电流
+    inputs_[sensor_input(i, Quantity::POWER_MW)] = is_used ? frame.power_mw[i] : 0.0f; // 功率
+  }
+
+  const uint32_t elapsed_ms = frame.timestamp_ms - last_frame_ms_; // 与上一帧的间隔
+  const bool is_integrating = has_last_frame_ && elapsed_ms <= config_.max_integration_gap_ms; // 首帧或间隔过长时不积分
+  const double hours_passed = is_integrating ? static_cast<double>(elapsed_ms) / 3600000.0 : 0.0; // 将毫秒转换为小时
+  has_last_frame_ = true; // 标记已处理
+  last_frame_ms_ = frame.timestamp_ms; // 记录时间戳
+
+  for (uint8_t i = 0; i < config_.channel_count; i++) // 按序号计算,后面的通道可以使用前面的结果
+  {
+    const ChannelDefinition &definition = config_.channels[i]; // 通道定义
+    const float a = inputs_[definition.input_a]; // 操作数a
+    const float b = inputs_[definition.input_b]; // 操作数b
+    const float numerator = definition.na * a + definition.nb * b + definition.nab * a * b; // 分子
+    const float denominator = definition.d0 + definition.db * b; // 分母
+    const float abs_denominator = fabsf(denominator); // 分母绝对值
+    const float value = (abs_denominator > 0.0f && abs_denominator >= definition.min_denominator) ? numerator / denominator : NAN; // 分母为0或过小时无意义
+    inputs_[SENSOR_INPUT_COUNT + i] = value; // 保存结果供后续通道引用
+    const float integrand = isnan(value) ? 0.0f : value; // 无效值按0计入
+    integrals_[i] += static_cast<double>(integration_weights_[i] * 0.5f * (previous_values_[i] + integrand)) * hours_passed; // 按权重梯形积分
+    previous_values_[i] = integrand; // 记录本帧值
+  }
+}
+
+float DerivedMetricEngine::get_value(uint8_t derived_index) const
+{
+  if (derived_index >= config_.channel_count) // 序号无效
+  {
+    return NAN; // 返回NAN
+  }
+  return inputs_[SENSOR_INPUT_COUNT + derived_index]; // 返回最新值
+}
+
+double DerivedMetricEngine::get_integrated(uint8_t derived_index) const
+{
+  if (derived_index >= config_.channel_count) // 序号无效
+  {
+    return 0.0; // 返回0
+  }
+  return integrals_[derived_index]; // 返回积分值
+}
+
+void DerivedMetricEngine::reset_integrals()
+{
+  for (uint8_t i = 0; i < MAX_DERIVED_CHANNELS; i++) // 逐个清零
+  {
+    integrals_[i] = 0.0; // 清零
+  }
+}
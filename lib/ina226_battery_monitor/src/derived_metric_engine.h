@@ -0,0 +1,159 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+
+#include "ina226_sync_group.h" // 包含INA226同步采样组
+
+/**
+ * @brief 跨传感器的派生通道计算(效率、净功率、损耗等)
+ * @note 每个派生通道统一表示为 (na*a + nb*b + nab*a*b) / (d0 + db*b),
+ *       和、差、积、比只是系数不同,逐帧计算时没有按运算类型的分支
+ * @note 操作数来自同步采样帧的各通道测量值,也可以引用序号更小的派生通道,
+ *       因此可以先求总输出功率再求效率
+ */
+class DerivedMetricEngine
+{
+public:
+  static constexpr uint8_t MAX_DERIVED_CHANNELS = 8; // 支持的最大派生通道数
+  static constexpr uint8_t QUANTITY_COUNT = 4; // 每个传感器通道的测量量个数
+  static constexpr uint8_t SENSOR_INPUT_COUNT = QUANTITY_COUNT * Ina226SyncGroup::MAX_CHANNELS; // 传感器输入个数
+  static constexpr uint8_t INPUT_COUNT = SENSOR_INPUT_COUNT + MAX_DERIVED_CHANNELS; // 操作数空间大小
+  static constexpr uint8_t INVALID_INPUT = 0xFF; // 无效的操作数序号,begin()会拒绝引用它的通道
+
+  /**
+   * @brief 传感器通道的测量量
+   */
+  enum class Quantity : uint8_t
+  {
+    BUS_VOLTAGE_V, // 总线电压(V)
+    SHUNT_VOLTAGE_MV, // 分流电压(mV)
+    CURRENT_MA, // 电流(mA)
+    POWER_MW, // 功率(mW)
+  };
+
+  /**
+   * @brief 派生通道定义
+   */
+  struct ChannelDefinition
+  {
+    uint8_t input_a = 0; // 操作数a的序号,由sensor_input()或derived_input()得到
+    uint8_t input_b = 0; // 操作数b的序号
+    float na = 0.0f; // a的系数
+    float nb = 0.0f; // b的系数
+    float nab = 0.0f; // a*b的系数
+    float d0 = 1.0f; // 分母常数项
+    float db = 0.0f; // 分母中b的系数
+    float min_denominator = 0.0f; // 分母绝对值低于此值时结果为NAN(如输入功率接近0时的效率),0表示只排除分母为0
+    bool is_integrated = false; // 是否对时间积分(功率通道积分得到mWh)
+  };
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    uint8_t channel_count = 0; // 派生通道数(1-MAX_DERIVED_CHANNELS)
+    ChannelDefinition channels[MAX_DERIVED_CHANNELS] = {}; // 派生通道定义,按序号顺序计算
+    uint32_t max_integration_gap_ms = 5000; // 相邻两帧间隔超过此值(ms)时不积分,避免停采期间按旧值外推
+  };
+
+  /**
+   * @brief 传感器测量量的操作数序号
+   * @param channel 同步采样组中的通道号
+   * @param quantity 测量量
+   * @return 操作数序号,通道号或测量量越界时返回INVALID_INPUT
+   */
+  static uint8_t sensor_input(uint8_t channel, Quantity quantity);
+
+  /**
+   * @brief 派生通道的操作数序号
+   * @param derived_index 派生通道序号,只能被序号更大的派生通道引用
+   * @return 操作数序号
+   */
+  static uint8_t derived_input(uint8_t derived_index);
+
+  /**
+   * @brief 定义和: scale*(a+b)
+   * @param input_a 操作数a
+   * @param input_b 操作数b
+   * @param scale 比例系数
+   * @return 通道定义
+   */
+  static ChannelDefinition make_sum(uint8_t input_a, uint8_t input_b, float scale = 1.0f);
+
+  /**
+   * @brief 定义差: scale*(a-b)
+   * @param input_a 操作数a
+   * @param input_b 操作数b
+   * @param scale 比例系数
+   * @return 通道定义
+   */
+  static ChannelDefinition make_difference(uint8_t input_a, uint8_t input_b, float scale = 1.0f);
+
+  /**
+   * @brief 定义积: scale*a*b
+   * @param input_a 操作数a
+   * @param input_b 操作数b
+   * @param scale 比例系数(如mA*V得到mW时为1)
+   * @return 通道定义
+   */
+  static ChannelDefinition make_product(uint8_t input_a, uint8_t input_b, float scale = 1.0f);
+
+  /**
+   * @brief 定义比: scale*a/b
+   * @param input_a 操作数a(分子)
+   * @param input_b 操作数b(分母)
+   * @param scale 比例系数(效率百分比时为100)
+   * @param min_denominator 分母绝对值低于此值时结果为NAN,0表示只排除分母为0
+   * @return 通道定义
+   */
+  static ChannelDefinition make_ratio(uint8_t input_a, uint8_t input_b, float scale = 1.0f, float min_denominator = 0.0f);
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit DerivedMetricEngine(const Config &config);
+
+  /**
+   * @brief 检查通道定义
+   * @return true 定义有效, false 操作数序号越界或引用了未计算的派生通道
+   */
+  bool begin();
+
+  /**
+   * @brief 按一帧同步采样计算全部派生通道并积分
+   * @param frame 同步采样帧
+   * @note 积分按相邻两帧的梯形计算,NAN按0计入
+   */
+  void update(const Ina226SyncGroup::Frame &frame);
+
+  /**
+   * @brief 获取派生通道的最新值
+   * @param derived_index 派生通道序号
+   * @return 最新值,分母为0、低于min_denominator或序号无效时返回NAN
+   */
+  float get_value(uint8_t derived_index) const;
+
+  /**
+   * @brief 获取派生通道的时间积分
+   * @param derived_index 派生通道序号
+   * @return 积分值(通道单位*h),未启用积分时为0
+   */
+  double get_integrated(uint8_t derived_index) const;
+
+  /**
+   * @brief 清零全部积分
+   */
+  void reset_integrals();
+
+private:
+  Config config_{}; // 配置副本
+  bool is_ready_ = false; // 是否已成功初始化
+  bool has_last_frame_ = false; // 是否已处理过一帧
+  uint32_t last_frame_ms_ = 0; // 上一帧的时间戳
+  float inputs_[INPUT_COUNT] = {}; // 操作数空间:传感器测量量在前,派生通道结果在后
+  float integration_weights_[MAX_DERIVED_CHANNELS] = {}; // 积分权重(1或0),避免逐帧按标志分支
+  double integrals_[MAX_DERIVED_CHANNELS] = {}; // 各派生通道的时间积分
+  float previous_values_[MAX_DERIVED_CHANNELS] = {}; // 上一帧的派生值(NAN已按0处理),用于梯形积分
+};
@@ -0,0 +1,150 @@
+#include "i2c_bus_arbiter.h" // 包含I2C总线仲裁器的头文件
+
+#include <freertos/task.h> // 包含任务延时接口
+
+I2cBusArbiter::BusState I2cBusArbiter::bus_states_[I2cBusArbiter::MAX_BUSES]; // 按TwoWire登记的共享状态
+portMUX_TYPE I2cBusArbiter::state_lock_ = portMUX_INITIALIZER_UNLOCKED; // 保护登记表与等待计数的自旋锁
+
+I2cBusArbiter::I2cBusArbiter(TwoWire *wire)
+    : wire_(wire != nullptr ? wire : &Wire) // 初始化I2C总线,默认Wire
+{
+}
+
+bool I2cBusArbiter::begin()
+{
+  if (bus_ != nullptr) // 已初始化
+  {
+    return true; // 返回成功
+  }
+
+  BusState *state = nullptr; // 本总线的共享状态
+  portENTER_CRITICAL(&state_lock_); // 进入临界区,多个任务同时初始化时只创建一个互斥量
+  for (size_t i = 0; i < MAX_BUSES && state == nullptr; i++) // 查找已登记的同一总线
+  {
+    if (bus_states_[i].wire == wire_) // 已有仲裁器登记了这条总线
+    {
+      state = &bus_states_[i]; // 共用其状态
+    }
+  }
+  for (size_t i = 0; i < MAX_BUSES && state == nullptr; i++) // 未登记时占用空闲槽位
+  {
+    if (bus_states_[i].wire == nullptr) // 空闲槽位
+    {
+      state = &bus_states_[i]; // 占用
+      state->wire = wire_; // 登记总线
+      state->mutex = xSemaphoreCreateMutexStatic(&state->mutex_buffer); // 创建互斥量(带优先级继承)
+    }
+  }
+  portEXIT_CRITICAL(&state_lock_); // 退出临界区
+
+  if (state == nullptr || state->mutex == nullptr) // 槽位已满或创建失败
+  {
+    return false; // 返回失败
+  }
+  bus_ = state; // 记录共享状态
+  return true; // 初始化成功
+}
+
+bool I2cBusArbiter::acquire(bool is_high_priority, uint32_t timeout_ms)
+{
+  if (bus_ == nullptr) // 未初始化
+  {
+    return false; // 返回失败
+  }
+
+  const uint32_t start_ms = millis(); // 记录开始时间
+  if (is_high_priority) // 高优先级请求
+  {
+    portENTER_CRITICAL(&state_lock_); // 进入临界区
+    bus_->high_priority_pending++; // 登记等待,让同一总线上所有仲裁器的低优先级用户让步
+    portEXIT_CRITICAL(&state_lock_); // 退出临界区
+    const bool is_taken = xSemaphoreTake(bus_->mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE; // 等待当前传输(最多一个块)结束
+    portENTER_CRITICAL(&state_lock_); // 进入临界区
+    bus_->high_priority_pending--; // 取消登记
+    portEXIT_CRITICAL(&state_lock_); // 退出临界区
+    return is_taken; // 返回结果
+  }
+
+  while (bus_->high_priority_pending > 0) // 有高优先级请求在等待
+  {
+    if ((millis() - start_ms) >= timeout_ms) // 超时
+    {
+      return false; // 返回失败
+    }
+    vTaskDelay(1); // 让出总线
+  }
+  const uint32_t elapsed_ms = millis() - start_ms; // 已等待时间
+  const uint32_t remaining_ms = elapsed_ms < timeout_ms ? timeout_ms - elapsed_ms : 0; // 剩余等待时间
+  return xSemaphoreTake(bus_->mutex, pdMS_TO_TICKS(remaining_ms)) == pdTRUE; // 获取互斥量
+}
+
+void I2cBusArbiter::release()
+{
+  if (bus_ != nullptr) // 已初始化
+  {
+    xSemaphoreGive(bus_->mutex); // 释放互斥量
+  }
+}
+
+bool I2cBusArbiter::write_chunked(uint8_t i2c_address, const uint8_t *prefix, size_t prefix_len, const uint8_t *data, size_t length,
+                                  size_t chunk_size)
+{
+  if (chunk_size == 0) // 无效分块大小
+  {
+    chunk_size = DEFAULT_CHUNK_SIZE; // 使用默认值
+  }
+
+  size_t offset = 0; // 已写入的数据长度
+  while (offset < length) // 逐块写入
+  {
+    const size_t block_len = (length - offset) < chunk_size ? (length - offset) : chunk_size; // 本块长度
+    if (!acquire(false)) // 每块单独获取总线,块间允许高优先级插入
+    {
+      return false; // 获取超时
+    }
+    wire_->beginTransmission(i2c_address); // 开始传输
+    if (prefix != nullptr && prefix_len > 0) // 有前缀
+    {
+      wire_->write(prefix, prefix_len); // 写入前缀
+    }
+    wire_->write(data + offset, block_len); // 写入数据块
+    const uint8_t result = wire_->endTransmission(); // 结束传输
+    release(); // 释放总线
+    if (result != 0) // 设备无应答或总线错误
+    {
+      return false; // 返回失败
+    }
+    offset += block_len; // 前进
+  }
+  return true; // 全部写入成功
+}
+
+TwoWire *I2cBusArbiter::get_wire() const
+{
+  return wire_; // 返回总线指针
+}
+
+I2cBusLock::I2cBusLock(I2cBusArbiter *arbiter, bool is_high_priority)
+    : arbiter_(arbiter), // 初始化仲裁器指针
+      is_acquired_(arbiter != nullptr && arbiter->acquire(is_high_priority)) // 获取总线
+{
+}
+
+I2cBusLock::~I2cBusLock()
+{
+  unlock(); // 释放总线
+}
+
+bool I2cBusLock::is_locked() const
+{
+  return arbiter_ == nullptr || is_acquired_; // 无仲裁器时总是可访问
+}
+
+void I2cBusLock::unlock()
+{
+  if (is_acquired_) // 实际获取了总线
+  {
+    arbiter_->release(); // 释放总线
+    is_acquired_ = false; // 标记已释放
+  }
+}
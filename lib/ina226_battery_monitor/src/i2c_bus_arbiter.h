@@ -0,0 +1,124 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <Wire.h> // 包含I2C通信库
+#include <freertos/FreeRTOS.h> // 包含FreeRTOS基础定义
+#include <freertos/semphr.h> // 包含FreeRTOS信号量
+
+/**
+ * @brief 共享I2C总线的仲裁器,同一TwoWire上的所有设备都经由它访问总线
+ * @note 互斥量与等待计数按TwoWire共享:为同一条总线构造多个仲裁器时,它们互相排斥
+ * @note 高优先级请求(电流采样)等待时,低优先级用户在获取总线前让步;
+ *       大块传输按块拆分,每块之间释放总线,高优先级请求最多等待一个块的传输时间
+ * @note 总线上的其他驱动(如OLED、EEPROM)必须经由write_chunked()或I2cBusLock访问;
+ *       直接调用Wire会绕过仲裁,传输可能与采样交错,或使采样等待整帧显示数据
+ */
+class I2cBusArbiter
+{
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 32; // 默认分块大小(字节),与Wire缓冲区匹配
+  static constexpr uint32_t DEFAULT_TIMEOUT_MS = 100; // 默认获取总线超时(ms)
+  static constexpr size_t MAX_BUSES = 2; // 支持的TwoWire数量(ESP32有两个I2C控制器)
+
+  /**
+   * @brief 构造函数
+   * @param wire 被仲裁的I2C总线,默认Wire
+   */
+  explicit I2cBusArbiter(TwoWire *wire = &Wire);
+
+  /**
+   * @brief 取得本总线共享的互斥量,首个仲裁器负责创建
+   * @return true 成功, false 已有MAX_BUSES条其他总线或创建失败
+   * @note 使用静态内存,不进行动态分配
+   */
+  bool begin();
+
+  /**
+   * @brief 获取总线
+   * @param is_high_priority 是否为高优先级请求
+   * @param timeout_ms 超时时间(ms)
+   * @return true 获取成功, false 超时或未初始化
+   */
+  bool acquire(bool is_high_priority, uint32_t timeout_ms = DEFAULT_TIMEOUT_MS);
+
+  /**
+   * @brief 释放总线
+   */
+  void release();
+
+  /**
+   * @brief 分块写入大块数据(如显示缓冲),每块为一次独立传输
+   * @param i2c_address 设备I2C地址
+   * @param prefix 每块开头重复发送的前缀(如OLED的数据控制字节),可为空
+   * @param prefix_len 前缀长度
+   * @param data 数据指针
+   * @param length 数据长度
+   * @param chunk_size 每块数据长度(不含前缀)
+   * @return true 全部写入成功, false 获取总线超时或设备无应答
+   */
+  bool write_chunked(uint8_t i2c_address, const uint8_t *prefix, size_t prefix_len, const uint8_t *data, size_t length,
+                     size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+  /**
+   * @brief 获取被仲裁的I2C总线
+   * @return TwoWire指针
+   */
+  TwoWire *get_wire() const;
+
+private:
+  /**
+   * @brief 一条TwoWire上所有仲裁器共享的状态
+   */
+  struct BusState
+  {
+    TwoWire *wire = nullptr; // 对应的I2C总线,nullptr表示空闲槽位
+    StaticSemaphore_t mutex_buffer{}; // 互斥量的静态存储
+    SemaphoreHandle_t mutex = nullptr; // 互斥量句柄
+    volatile uint32_t high_priority_pending = 0; // 正在等待的高优先级请求数
+  };
+
+  static BusState bus_states_[MAX_BUSES]; // 按TwoWire登记的共享状态
+  static portMUX_TYPE state_lock_; // 保护登记表与等待计数的自旋锁
+
+  TwoWire *wire_; // I2C总线指针
+  BusState *bus_ = nullptr; // 本总线的共享状态,begin()后有效
+};
+
+/**
+ * @brief 作用域内持有总线的辅助类,析构时自动释放
+ * @note 仲裁器为空时不做任何事,便于未配置仲裁器的场景直接使用
+ */
+class I2cBusLock
+{
+public:
+  /**
+   * @brief 构造时获取总线
+   * @param arbiter 仲裁器指针,可为空
+   * @param is_high_priority 是否为高优先级请求
+   */
+  I2cBusLock(I2cBusArbiter *arbiter, bool is_high_priority);
+
+  /**
+   * @brief 析构时释放总线
+   */
+  ~I2cBusLock();
+
+  /**
+   * @brief 是否可以访问总线
+   * @return true 已获取或无需仲裁, false 获取超时
+   */
+  bool is_locked() const;
+
+  /**
+   * @brief 提前释放总线
+   * @note 寄存器访问结束后调用,避免在后续计算期间占用总线;析构时不再重复释放
+   */
+  void unlock();
+
+  I2cBusLock(const I2cBusLock &) = delete; // 禁止拷贝
+  I2cBusLock &operator=(const I2cBusLock &) = delete; // 禁止赋值
+
+private:
+  I2cBusArbiter *arbiter_; // 仲裁器指针
+  bool is_acquired_; // 是否实际获取了总线
+};
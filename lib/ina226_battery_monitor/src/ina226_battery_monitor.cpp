@@ -1,15 +1,51 @@
 #include "ina226_battery_monitor.h" // 包含INA226电池监视器的头文件
 
+#include "battery_chemistry_profiles.h" // 包含电池化学体系预设
+#include "battery_event_log.h" // 包含电池事件日志
+#include "i2c_bus_arbiter.h" // 包含I2C总线仲裁器
+#include "ina226_timing.h" // 包含INA226转换耗时计算
+#include "sample_text_formatter.h" // 包含定点文本格式化
+
+#include <driver/gpio.h> // 包含GPIO中断服务接口
+#include <esp_system.h> // 包含复位原因查询接口
+#include <soc/gpio_reg.h> // 包含GPIO输出寄存器地址
+#include <soc/soc.h> // 包含寄存器读写宏
+#include <stdlib.h> // 包含字符串转换函数
+
 #include <Preferences.h> // 包含Preferences库，用于NVS存储
 
 #include <math.h> // 包含数学库
 #include <stdarg.h> // 包含可变参数处理库
 #include <stddef.h> // 包含标准定义库
 #include <stdio.h> // 包含标准输入输出库
+#include <string.h> // 包含内存操作函数
 
 static constexpr uint32_t k_battery_state_magic = 0x42415431; // 定义电池状态魔数，用于校验NVS数据 ('BAT1')
-static constexpr uint16_t k_battery_state_version = 1; // 定义电池状态版本号
+static constexpr uint16_t k_battery_state_version = 2; // 定义电池状态版本号
+static constexpr size_t k_battery_state_v1_size = 20; // 版本1(不含保存时间)的状态大小,兼容旧数据
+static constexpr uint32_t k_seconds_per_month = 30UL * 24UL * 3600UL; // 自放电模型中一个月的秒数
+static constexpr uint32_t k_max_off_time_s = 5UL * 365UL * 24UL * 3600UL; // 超过此关机时长视为时间异常,不做补偿
+static constexpr float k_bus_voltage_lsb_v = 1.25e-3f; // INA226总线电压寄存器LSB(V)
+static constexpr float k_shunt_voltage_lsb_mv = 2.5e-3f; // INA226分流电压寄存器LSB(mV)
+static constexpr float k_shunt_voltage_saturation_mv = 80.0f; // 分流电压ADC满量程为81.92mV,超过此值视为饱和
+static constexpr uint32_t k_retained_state_magic = 0x52544D31; // RTC热重启快照魔数 ('RTM1')
+static constexpr uint16_t k_retained_state_version = 1; // RTC热重启快照版本号
+static constexpr uint32_t k_nvs_writer_stack_size = 4096; // 后台NVS写入任务栈大小(字节),Preferences写入需要约3KB
+static constexpr UBaseType_t k_nvs_writer_priority = tskIDLE_PRIORITY + 1; // 后台NVS写入任务优先级,不高于采样任务
  
+RTC_NOINIT_ATTR Ina226BatteryMonitor::RetainedMonitorState Ina226BatteryMonitor::retained_state_; // 复位时不清零,上电时为随机值
+
+/**
+ * @brief 判断复位原因是否保留了RTC内存且积分状态仍然可信
+ * @param reason 复位原因
+ * @return true 软件复位(含OTA重启)、异常或看门狗复位, false 上电、外部复位、欠压或深度睡眠唤醒
+ */
+static bool is_warm_reset_reason(esp_reset_reason_t reason)
+{
+  return reason == ESP_RST_SW || reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT || // 软件复位或异常
+         reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT; // 看门狗复位
+}
+
 // 默认的SOC（荷电状态）查表，电压对应百分比
 const Ina226BatteryMonitor::SocPoint Ina226BatteryMonitor::k_default_soc_table_[] = {
     {12.60f, 100.0f}, // 12.60V 对应 100%
@@ -25,17 +61,40 @@ const Ina226BatteryMonitor::SocPoint Ina226BatteryMonitor::k_default_soc_table_[
     {9.00f, 0.0f},    // 9.00V 对应 0%
 };
 
+/**
+ * @brief 由监视器配置生成剩余时间预测器配置
+ * @param config 监视器配置
+ * @return 预测器配置
+ */
+static RuntimePredictor::Config make_runtime_predictor_config(const Ina226BatteryMonitor::Config &config)
+{
+  RuntimePredictor::Config predictor_config{}; // 预测器配置
+  predictor_config.filter_time_constant_s = config.runtime_filter_time_constant_s; // 平滑时间常数
+  predictor_config.idle_threshold_ma = config.current_deadzone_ma; // 低于死区的平滑电流视为静置
+  predictor_config.is_constant_power = config.enable_constant_power_runtime; // 是否按恒功率预测
+  return predictor_config; // 返回配置
+}
+
 // 构造函数，初始化配置和成员变量
 Ina226BatteryMonitor::Ina226BatteryMonitor(const Config &config)
     : config_(config), // 初始化配置结构体
       ina226_(config.i2c_address, config.wire != nullptr ? config.wire : &Wire), // 初始化INA226对象，设置I2C地址和Wire对象
+      low_range_ina226_(config.low_range_i2c_address, config.wire != nullptr ? config.wire : &Wire), // 初始化低量程INA226对象,与本通道共用总线
       remaining_capacity_mah_(config.battery_capacity_mah), // 初始化剩余容量为电池总容量
-      soc_percent_(100.0f) // 初始化SOC为100%
+      soc_percent_(100.0f), // 初始化SOC为100%
+      runtime_predictor_(make_runtime_predictor_config(config)) // 初始化剩余时间预测器
 {
   if (config_.wire == nullptr) // 如果配置中的Wire指针为空
   {
     config_.wire = &Wire; // 默认使用Wire
   }
+  if (config_.bus_voltage_read_divider == 0) // 总线电压从不读取时保护会一直看到0V,功率也无法推算
+  {
+    config_.bus_voltage_read_divider = 1; // 修正为每次读取
+  }
+
+  apply_battery_preset(); // 应用电池化学体系预设
+  build_rate_factor_table(); // 预计算放电倍率修正系数表
 }
 
 void Ina226BatteryMonitor::set_logger(Print *logger)
@@ -43,6 +102,26 @@ void Ina226BatteryMonitor::set_logger(Print *logger)
   logger_ = logger; // 保存日志对象指针
 }
 
+void Ina226BatteryMonitor::set_cell_voltage_monitor(CellVoltageMonitor *cell_monitor)
+{
+  cell_monitor_ = cell_monitor; // 保存单节电压监视器指针
+}
+
+void Ina226BatteryMonitor::set_temperature_source(TemperatureSource *temperature_source)
+{
+  temperature_source_ = temperature_source; // 保存温度源指针
+}
+
+void Ina226BatteryMonitor::set_event_log(BatteryEventLog *event_log)
+{
+  event_log_ = event_log; // 保存事件日志指针
+}
+
+void Ina226BatteryMonitor::set_bus_arbiter(I2cBusArbiter *bus_arbiter)
+{
+  bus_arbiter_ = bus_arbiter; // 保存总线仲裁器指针
+}
+
 bool Ina226BatteryMonitor::begin()
 {
   if (config_.init_wire) // 如果配置要求初始化Wire
@@ -57,64 +136,202 @@ bool Ina226BatteryMonitor::begin()
     }
   }
 
-  if (!ina226_.begin()) // 初始化INA226传感器
+  bool is_low_range_missing = false; // 低量程INA226是否无响应
   {
-    return false; // 如果失败返回false
-  }
+    I2cBusLock bus_lock(bus_arbiter_, true); // 只在配置寄存器期间占用共享总线
+    if (!bus_lock.is_locked()) // 获取总线失败(仲裁器未初始化或超时)
+    {
+      logf("I2C bus arbiter not available\n"); // 打印日志：总线不可用
+      return false; // 返回失败
+    }
+
+    if (!ina226_.begin()) // 初始化INA226传感器
+    {
+      return false; // 如果失败返回false
+    }
 
-  ina226_.setMaxCurrentShunt(config_.max_current_amps, config_.shunt_resistor_ohm); // 设置最大电流和分流电阻值
-  ina226_.setAverage(config_.average); // 设置平均采样次数
+    ina226_.setMaxCurrentShunt(config_.max_current_amps, config_.shunt_resistor_ohm); // 设置最大电流和分流电阻值
+    update_raw_thresholds(); // 预计算原始寄存器模式的整数阈值
+    ina226_.setAverage(config_.average); // 设置平均采样次数
 
-  const uint32_t samples = config_.startup_voltage_samples > 0 ? config_.startup_voltage_samples : 1; // 确定启动电压采样次数
-  float total_voltage = 0.0f; // 总电压累加变量
-  for (uint32_t i = 0; i < samples; i++) // 循环采样
-  {
-    total_voltage += ina226_.getBusVoltage(); // 读取总线电压并累加
-    if (config_.startup_voltage_sample_delay_ms > 0) // 如果配置了采样延迟
+    if (config_.enable_dual_shunt) // 双分流模式
     {
-      delay(config_.startup_voltage_sample_delay_ms); // 延时等待
+      if (low_range_ina226_.begin()) // 初始化低量程INA226
+      {
+        low_range_ina226_.setMaxCurrentShunt(config_.low_range_shunt_max_current_amps, config_.low_range_shunt_resistor_ohm); // 设置低量程最大电流和分流电阻值
+        low_range_ina226_.setAverage(config_.average); // 与本通道相同的平均点数,保证两路同步
+      }
+      else
+      {
+        config_.enable_dual_shunt = false; // 退回单分流
+        is_low_range_missing = true; // 释放总线后再打印日志
+      }
     }
   }
+  if (is_low_range_missing) // 低量程通道初始化失败
+  {
+    logf("Low-range INA226 not found, dual shunt disabled\n"); // 打印日志：低量程通道初始化失败
+  }
 
-  const float startup_voltage_v = total_voltage / static_cast<float>(samples); // 计算平均启动电压
-  soc_percent_ = get_soc_from_voltage(startup_voltage_v); // 根据电压估算初始SOC
-  remaining_capacity_mah_ = (static_cast<double>(soc_percent_) / 100.0) * config_.battery_capacity_mah; // 根据SOC计算剩余容量
+  const esp_reset_reason_t reset_reason = esp_reset_reason(); // 查询复位原因
+  const bool is_warm_restart = config_.enable_warm_restart && is_warm_reset_reason(reset_reason) && restore_retained_state(); // 热重启时从RTC内存恢复
+  clock_.sync_epoch_from_system_time(millis()); // 软件复位/深度睡眠后系统时间仍有效时恢复绝对时间
 
-  double saved_remaining_capacity_mah = 0.0; // 用于存储从NVS读取的剩余容量
-  if (load_remaining_capacity_from_nvs(saved_remaining_capacity_mah)) // 尝试从NVS加载剩余容量
+  float startup_voltage_v = NAN; // 启动电压,热重启时不采样
+  float boot_abs_current_ma = 0.0f; // 启动时的电流绝对值,用于开路电压置信度
   {
-    remaining_capacity_mah_ = saved_remaining_capacity_mah; // 如果成功，更新剩余容量
-    if (remaining_capacity_mah_ < 0.0) // 边界检查：小于0
-      remaining_capacity_mah_ = 0.0; // 修正为0
-    if (remaining_capacity_mah_ > config_.battery_capacity_mah) // 边界检查：大于总容量
-      remaining_capacity_mah_ = config_.battery_capacity_mah; // 修正为总容量
+    I2cBusLock bus_lock(bus_arbiter_, true); // 告警寄存器配置与开路电压读取期间占用共享总线
+    if (!bus_lock.is_locked()) // 获取总线超时
+    {
+      logf("I2C bus arbiter not available\n"); // 打印日志：总线不可用
+      return false; // 返回失败
+    }
+    is_output_deferred_ = true; // 持有总线期间日志与事件延后到释放之后
+
+    begin_protection(); // 初始化保护引脚与硬件告警
+    if (protection_faults_ != 0) // 恢复了复位前的保护故障
+    {
+      set_load_enabled(false); // 保持负载断开,由正常的解除逻辑恢复
+    }
+
+    if (!is_warm_restart) // 冷启动时采样启动电压
+    {
+      const uint32_t start_us = micros(); // 记录开始时间,用于统计启动耗时
+      const bool is_hw_averaged = config_.enable_startup_hw_average && measure_startup_voltage_hw_average(startup_voltage_v); // 优先使用硬件平均
+      if (!is_hw_averaged) // 未启用或硬件平均失败,使用软件循环
+      {
+        const uint32_t samples = config_.startup_voltage_samples > 0 ? config_.startup_voltage_samples : 1; // 确定启动电压采样次数
+        float total_voltage = 0.0f; // 总电压累加变量
+        for (uint32_t i = 0; i < samples; i++) // 循环采样
+        {
+          total_voltage += ina226_.getBusVoltage(); // 读取总线电压并累加
+          if (config_.startup_voltage_sample_delay_ms > 0) // 如果配置了采样延迟
+          {
+            delay(config_.startup_voltage_sample_delay_ms); // 延时等待
+          }
+        }
+        startup_voltage_v = total_voltage / static_cast<float>(samples); // 计算平均启动电压
+      }
+      boot_abs_current_ma = fabsf(ina226_.getCurrent_mA()); // 启动时带载会使电压偏离开路电压
+      logf("Startup voltage: %s V (%s, %lu us)\n", FixedPointText(startup_voltage_v, 3).c_str(), is_hw_averaged ? "hw avg" : "sw avg", // 打印日志：启动电压与耗时
+           static_cast<unsigned long>(micros() - start_us));
+    }
+    sample_.bus_voltage_v = startup_voltage_v; // 更新样本数据：总线电压
+
+    if (cell_monitor_ != nullptr) // 挂接了单节电压监视器
+    {
+      if (cell_monitor_->begin() && cell_monitor_->scan()) // 初始化并立即扫描一次
+      {
+        update_cell_voltages(millis()); // 填充单节统计
+      }
+      else
+      {
+        logf("Cell monitor init failed, using pack voltage\n"); // 打印日志：单节监视器初始化失败
+        cell_monitor_ = nullptr; // 退回整包电压估算
+      }
+    }
+
+    if (temperature_source_ != nullptr) // 挂接了温度源
+    {
+      if (temperature_source_->begin()) // 初始化温度源
+      {
+        temperature_source_->start_measurement(); // 立即发起第一次测量
+        last_temperature_request_ms_ = millis(); // 记录发起时间
+      }
+      else
+      {
+        logf("Temperature source init failed\n"); // 打印日志：温度源初始化失败
+        temperature_source_ = nullptr; // 不使用温度补偿
+      }
+    }
+    is_output_deferred_ = false; // 恢复直接输出
+  }
+  flush_deferred_output(); // 总线已释放,输出延后的日志
 
+  if (is_warm_restart) // 热重启：状态已从RTC内存恢复,跳过NVS读取
+  {
     soc_percent_ = static_cast<float>((remaining_capacity_mah_ / config_.battery_capacity_mah) * 100.0); // 重新计算SOC百分比
-    logf("NVS loaded: remaining=%.2f mAh (SoC %.3f%%)\n", remaining_capacity_mah_, soc_percent_); // 打印日志：NVS加载成功
+    logf("Warm restart: remaining=%s mAh (SoC %s%%)\n", FixedPointText(static_cast<float>(remaining_capacity_mah_), 2).c_str(), FixedPointText(soc_percent_, 3).c_str()); // 打印日志：热重启恢复
   }
   else
   {
-    if (is_nvs_enabled()) // 如果NVS已启用但加载失败
+    soc_percent_ = estimate_soc_from_voltage(startup_voltage_v); // 根据电压估算初始SOC
+    remaining_capacity_mah_ = (static_cast<double>(soc_percent_) / 100.0) * config_.battery_capacity_mah; // 根据SOC计算剩余容量
+
+    double saved_remaining_capacity_mah = 0.0; // 用于存储从NVS读取的剩余容量
+    float saved_charge_efficiency = NAN; // 用于存储从NVS读取的充电效率
+    uint32_t saved_epoch_s = 0; // 用于存储从NVS读取的保存时间
+    const float ocv_soc_percent = soc_percent_; // 保留开路电压估算结果,用于启动仲裁
+    if (load_remaining_capacity_from_nvs(saved_remaining_capacity_mah, saved_charge_efficiency, saved_epoch_s)) // 尝试从NVS加载剩余容量
     {
-      logf("NVS not found/invalid, using OCV estimate and seeding NVS...\n"); // 打印日志：NVS未找到或无效，使用OCV估算并初始化NVS
-      if (save_remaining_capacity_to_nvs(remaining_capacity_mah_)) // 尝试将当前估算的容量写入NVS
+      remaining_capacity_mah_ = saved_remaining_capacity_mah; // 如果成功，更新剩余容量
+      if (config_.enable_efficiency_learning) // 启用学习时恢复已学习的效率
       {
-        logf("NVS seeded: remaining=%.2f mAh (SoC %.3f%%)\n", remaining_capacity_mah_, soc_percent_); // 打印日志：NVS初始化成功
+        learned_charge_efficiency_ = saved_charge_efficiency; // 更新学习到的充电效率
       }
-      else
+      if (remaining_capacity_mah_ < 0.0) // 边界检查：小于0
+        remaining_capacity_mah_ = 0.0; // 修正为0
+      if (remaining_capacity_mah_ > config_.battery_capacity_mah) // 边界检查：大于总容量
+        remaining_capacity_mah_ = config_.battery_capacity_mah; // 修正为总容量
+
+      soc_percent_ = static_cast<float>((remaining_capacity_mah_ / config_.battery_capacity_mah) * 100.0); // 重新计算SOC百分比
+      logf("NVS loaded: remaining=%s mAh (SoC %s%%)\n", FixedPointText(static_cast<float>(remaining_capacity_mah_), 2).c_str(), FixedPointText(soc_percent_, 3).c_str()); // 打印日志：NVS加载成功
+
+      if (saved_epoch_s != 0) // 保存时已知绝对时间,可以计算关机时长
+      {
+        is_off_period_pending_ = true; // 标记待补偿
+        saved_epoch_s_ = saved_epoch_s; // 记录上次保存时间
+        if (clock_.has_epoch()) // 当前时间已知
+        {
+          apply_off_period_compensation(); // 立即补偿;否则等待set_epoch_ms()
+        }
+      }
+      arbitrate_boot_soc(ocv_soc_percent, boot_abs_current_ma); // 与开路电压估算仲裁
+    }
+    else
+    {
+      if (is_nvs_enabled()) // 如果NVS已启用但加载失败
       {
-        logf("NVS seed failed\n"); // 打印日志：NVS初始化失败
+        record_event(BatteryEventType::NVS_LOAD_FAILED); // 记录事件：NVS加载失败
+        logf("NVS not found/invalid, using OCV estimate and seeding NVS...\n"); // 打印日志：NVS未找到或无效，使用OCV估算并初始化NVS
+        if (save_remaining_capacity_to_nvs(remaining_capacity_mah_)) // 尝试将当前估算的容量写入NVS
+        {
+          logf("NVS seeded: remaining=%s mAh (SoC %s%%)\n", FixedPointText(static_cast<float>(remaining_capacity_mah_), 2).c_str(), FixedPointText(soc_percent_, 3).c_str()); // 打印日志：NVS初始化成功
+        }
+        else
+        {
+          logf("NVS seed failed\n"); // 打印日志：NVS初始化失败
+          record_event(BatteryEventType::NVS_SAVE_FAILED); // 记录事件：NVS保存失败
+        }
       }
     }
   }
 
-  sample_.bus_voltage_v = startup_voltage_v; // 更新样本数据：总线电压
   sample_.remaining_capacity_mah = remaining_capacity_mah_; // 更新样本数据：剩余容量
   sample_.soc_percent = soc_percent_; // 更新样本数据：SOC
 
-  last_time_ms_ = millis(); // 记录当前时间
-  last_nvs_save_ms_ = last_time_ms_; // 初始化上次NVS保存时间
-  last_saved_remaining_capacity_mah_ = remaining_capacity_mah_; // 初始化上次保存的容量
+  record_event(BatteryEventType::BOOT, static_cast<uint32_t>(reset_reason)); // 记录事件：启动
+  if (reset_reason == ESP_RST_BROWNOUT) // 欠压复位
+  {
+    record_event(BatteryEventType::BROWNOUT_RESET); // 记录事件：欠压复位
+  }
+
+  last_update_monotonic_ms_ = clock_.extend(millis()); // 记录当前时间
+  last_nvs_save_ms_ = millis(); // 初始化上次NVS保存时间
+  last_raw_sample_ms_ = last_nvs_save_ms_; // 原始寄存器模式的积分起点
+  last_raw_fold_ms_ = last_nvs_save_ms_; // 原始寄存器模式的折算起点
+  if (!is_warm_restart) // 热重启时保留恢复的值,未保存的变化量在下次保存时写入NVS
+  {
+    last_saved_remaining_capacity_mah_ = remaining_capacity_mah_; // 初始化上次保存的容量
+  }
+  if (config_.enable_warm_restart) // 启用热重启
+  {
+    save_retained_state(); // 立即写入快照
+  }
+  if (is_nvs_enabled() && config_.enable_background_nvs_save && nvs_writer_task_ == nullptr && !start_nvs_writer()) // 创建后台写入任务
+  {
+    logf("NVS writer task not started, saving inline\n"); // 打印日志：退回同步写入
+  }
   return true; // 初始化成功
 }
 
@@ -125,14 +342,89 @@ void Ina226BatteryMonitor::update(Stream *serial)
 
 void Ina226BatteryMonitor::update(uint32_t now_ms, Stream *serial)
 {
-  sample_.bus_voltage_v = ina226_.getBusVoltage(); // 读取总线电压
-  sample_.shunt_voltage_mv = ina226_.getShuntVoltage_mV(); // 读取分流电压
-  sample_.current_ma = static_cast<float>(config_.current_polarity) * ina226_.getCurrent_mA(); // 读取电流并应用极性
-  sample_.power_mw = ina226_.getPower_mW(); // 读取功率
+  if (has_update_call_) // 统计采样间隔
+  {
+    const uint32_t gap_ms = now_ms - last_update_call_ms_; // 与上次调用的间隔
+    if (gap_ms > sample_gap_stats_.max_gap_ms) // 更新最大间隔
+      sample_gap_stats_.max_gap_ms = gap_ms; // 记录最大间隔
+    if (config_.sample_gap_threshold_ms > 0 && gap_ms > config_.sample_gap_threshold_ms) // 超过阈值
+      sample_gap_stats_.gap_count++; // 计为一次缺口
+  }
+  has_update_call_ = true; // 标记已调用
+  last_update_call_ms_ = now_ms; // 记录调用时间
+
+  I2cBusLock bus_lock(bus_arbiter_, true); // 以高优先级占用共享总线,其他设备最多让采样等待一个传输块
+  if (!bus_lock.is_locked()) // 获取总线超时
+  {
+    sample_gap_stats_.bus_lock_timeout_count++; // 计入诊断统计
+    return; // 跳过本次采样,下次更新按实际间隔积分
+  }
+  is_output_deferred_ = true; // 持有总线期间只做比较与驱动负载开关,日志与事件(串口、Flash)延后到释放之后
+
+  float abs_current_ma = 0.0f; // 电流绝对值
+  float effective_current_ma = 0.0f; // 参与积分的有效电流
+  bool is_fold_due = true; // 本次是否做浮点换算与容量积分
+  if (config_.enable_raw_sample_path) // 原始寄存器模式
+  {
+    is_fold_due = update_raw(now_ms); // 每次都做整数积分与保护,到达折算周期才做浮点处理
+    if (is_fold_due)
+    {
+      refresh_sample_from_raw(); // 浮点处理需要最新的样本字段
+      abs_current_ma = fabsf(sample_.current_ma); // 计算电流绝对值
+      effective_current_ma = fold_raw_charge(); // 折算周期内的平均电流,整数积分已应用死区
+    }
+  }
+  else
+  {
+    if (is_register_read_due(config_.bus_voltage_read_divider)) // 总线电压变化慢,按分频读取
+    {
+      sample_.bus_voltage_v = ina226_.getBusVoltage(); // 读取总线电压
+    }
+    const bool is_shunt_voltage_due = is_range_settling_ || is_register_read_due(config_.shunt_voltage_read_divider); // 按分频读取分流电压,切换量程后必须读取
+    if (is_shunt_voltage_due)
+    {
+      sample_.shunt_voltage_mv = ina226_.getShuntVoltage_mV(); // 读取分流电压
+    }
+    if (is_range_settling_) // 刚切换量程,电流寄存器尚未按新校准更新
+    {
+      sample_.current_ma = static_cast<float>(config_.current_polarity) * sample_.shunt_voltage_mv / config_.shunt_resistor_ohm; // 由分流电压推算电流(mV/Ohm=mA),与校准无关
+      is_range_settling_ = false; // 下一次恢复读取电流寄存器
+    }
+    else
+    {
+      sample_.current_ma = static_cast<float>(config_.current_polarity) * ina226_.getCurrent_mA(); // 读取电流并应用极性,每次都读
+    }
+    if (config_.enable_dual_shunt) // 双分流模式
+    {
+      sample_.current_ma = merge_dual_shunt_current(sample_.current_ma); // 与低量程通道合并
+    }
+    abs_current_ma = fabsf(sample_.current_ma); // 计算电流绝对值
+    if (!is_shunt_voltage_due) // 本次未读取分流电压
+    {
+      sample_.shunt_voltage_mv = static_cast<float>(config_.current_polarity) * sample_.current_ma * config_.shunt_resistor_ohm; // 由电流推算(mA*Ohm=mV)
+    }
+    if (is_register_read_due(config_.power_read_divider)) // 按分频读取功率
+    {
+      sample_.power_mw = ina226_.getPower_mW(); // 读取功率
+    }
+    else
+    {
+      sample_.power_mw = sample_.bus_voltage_v * abs_current_ma; // 由电压*电流推算
+    }
+    register_read_cycle_++; // 推进调度计数
 
-  const float abs_current_ma = fabsf(sample_.current_ma); // 计算电流绝对值
-  sample_.power2_mw = sample_.bus_voltage_v * abs_current_ma; // 计算功率（电压*电流绝对值）
-  const float effective_current_ma = (abs_current_ma < config_.current_deadzone_ma) ? 0.0f : sample_.current_ma; // 应用电流死区，小于死区视为0
+    sample_.power2_mw = sample_.bus_voltage_v * abs_current_ma; // 计算功率（电压*电流绝对值）
+    effective_current_ma = (abs_current_ma < config_.current_deadzone_ma) ? 0.0f : sample_.current_ma; // 应用电流死区，小于死区视为0
+
+    update_protection(now_ms, abs_current_ma > config_.over_current_ma, sample_.bus_voltage_v < config_.under_voltage_v, // 在采样路径中评估保护,响应时间以采样周期为界
+                      sample_.bus_voltage_v >= config_.under_voltage_v + config_.under_voltage_hysteresis_v);
+    update_auto_range(now_ms, abs_current_ma); // 按电流切换量程
+  }
+  update_cell_voltages(now_ms); // 按扫描周期更新单节电压
+  update_temperature(now_ms); // 按测量周期更新温度
+  bus_lock.unlock(); // 寄存器访问结束,尽早释放总线
+  is_output_deferred_ = false; // 恢复直接输出
+  flush_deferred_output(); // 输出保护与量程切换的日志和事件
 
   if (serial != nullptr && serial->available() > 0) // 如果串口可用且有数据
   {
@@ -140,21 +432,72 @@ void Ina226BatteryMonitor::update(uint32_t now_ms, Stream *serial)
     if (cmd == 'c' || cmd == 'C') // 如果是清除命令 'c'
     {
       clear_nvs_state(); // 清除NVS状态
-      reset_state_from_voltage(sample_.bus_voltage_v);
+      reset_state_from_voltage(sample().bus_voltage_v); // 原始寄存器模式下先换算最新电压
+      record_event(BatteryEventType::NVS_CLEARED); // 记录事件：清除NVS
       maybe_save_to_nvs(now_ms, true); // 强制保存到NVS
     }
     else if (cmd == 'r' || cmd == 'R') // 如果是重置命令 'r'
     {
-      reset_state_from_voltage(sample_.bus_voltage_v); 
+      reset_state_from_voltage(sample().bus_voltage_v); // 原始寄存器模式下先换算最新电压
+      record_event(BatteryEventType::SOC_RESET_FROM_VOLTAGE); // 记录事件：按电压重置
       maybe_save_to_nvs(now_ms, true); // 强制保存到NVS
     }
+    else if ((cmd == 'd' || cmd == 'D') && event_log_ != nullptr) // 如果是导出事件日志命令 'd'
+    {
+      event_log_->dump(*serial); // 导出全部事件记录
+    }
+    else if (cmd == 't' || cmd == 'T') // 如果是设置时间命令 't'
+    {
+      handle_set_time_command(serial); // 解析Unix时间并设置
+    }
+    else if (cmd == 's' || cmd == 'S') // 如果是强制保存命令 's'
+    {
+      maybe_save_to_nvs(now_ms, true); // 强制保存到NVS
+      logf("Forced save: last %lu us, max gap %lu ms, gaps %lu, bus timeouts %lu\n", // 打印日志：最近一次完成的保存耗时与采样间隔统计
+           static_cast<unsigned long>(sample_gap_stats_.last_nvs_save_us),
+           static_cast<unsigned long>(sample_gap_stats_.max_gap_ms),
+           static_cast<unsigned long>(sample_gap_stats_.gap_count),
+           static_cast<unsigned long>(sample_gap_stats_.bus_lock_timeout_count));
+    }
+  }
+
+  if (is_fold_due) // 原始寄存器模式下未到折算周期时样本字段未换算,不积分也不做满充/静置判断
+  {
+    update_state_of_charge(now_ms, abs_current_ma, effective_current_ma); // 容量积分与状态判断
+  }
+
+  collect_nvs_save_result(); // 取回后台写入的结果
+  maybe_save_to_nvs(now_ms, false); // 尝试保存到NVS（非强制）
+
+  sample_.remaining_capacity_mah = remaining_capacity_mah_; // 更新样本数据：剩余容量
+  sample_.soc_percent = soc_percent_; // 更新样本数据：SoC
+  if (config_.enable_warm_restart) // 启用热重启
+  {
+    save_retained_state(); // 每次更新后写入RTC内存快照
   }
+}
 
-  const uint32_t elapsed_ms = now_ms - last_time_ms_; // 计算距离上次更新的时间差
+void Ina226BatteryMonitor::update_state_of_charge(uint32_t now_ms, float abs_current_ma, float effective_current_ma)
+{
+  const uint64_t now_monotonic_ms = clock_.extend(now_ms); // 扩展为64位单调时间,跨越millis()回绕
+  sample_.timestamp_ms = clock_.to_record_timestamp_ms(now_monotonic_ms); // 更新样本数据：时间戳
+  const uint64_t elapsed_monotonic_ms = now_monotonic_ms - last_update_monotonic_ms_; // 计算距离上次更新的时间差
+  const uint32_t elapsed_ms = elapsed_monotonic_ms > 0xFFFFFFFFULL ? 0xFFFFFFFFu : static_cast<uint32_t>(elapsed_monotonic_ms); // 限制在32位范围内
   if (elapsed_ms > 0) // 如果有时间流逝
   {
     const double hours_passed = static_cast<double>(elapsed_ms) / 3600000.0; // 将毫秒转换为小时
-    const double mah_delta = static_cast<double>(effective_current_ma) * hours_passed; // 计算消耗/充电的mAh（电流积分）
+    double mah_delta = static_cast<double>(effective_current_ma) * hours_passed; // 计算消耗/充电的mAh（电流积分）
+    if (effective_current_ma > 0.0f) // 放电时按放电倍率修正实际消耗
+    {
+      cycle_discharge_out_mah_ += mah_delta; // 累计本循环放出电量
+      mah_delta *= get_rate_capacity_factor(effective_current_ma) / capacity_temp_factor_; // 大电流或低温放电时有效容量变小,等效消耗更多
+    }
+    else if (effective_current_ma < 0.0f) // 充电时按库仑效率折算实际充入
+    {
+      const double efficiency_factor = static_cast<double>(calc_charge_efficiency_factor()) * charge_temp_factor_; // 当前SOC与温度下的效率系数
+      cycle_charge_in_mah_ -= mah_delta * efficiency_factor; // 累计本循环充入电量(不含基础效率,供学习使用)
+      mah_delta *= efficiency_factor * get_charge_efficiency(); // 充入电量乘以充电效率
+    }
     remaining_capacity_mah_ -= mah_delta; // 更新剩余容量（减去变化量，注意电流符号）
 
     if (remaining_capacity_mah_ < 0.0) // 边界检查：小于0
@@ -163,31 +506,114 @@ void Ina226BatteryMonitor::update(uint32_t now_ms, Stream *serial)
       remaining_capacity_mah_ = config_.battery_capacity_mah; // 修正为总容量
 
     soc_percent_ = static_cast<float>((remaining_capacity_mah_ / config_.battery_capacity_mah) * 100.0); // 重新计算SOC
-    last_time_ms_ = now_ms; // 更新上次时间
+    cap_soc_at_weakest_cell(elapsed_ms, abs_current_ma); // 静置电流下不高于最弱单节SOC
+    last_update_monotonic_ms_ = now_monotonic_ms; // 更新上次时间
+
+    update_runtime_prediction(elapsed_ms, effective_current_ma); // 更新剩余时间预测
   }
 
+  const double rearm_capacity_mah = config_.battery_capacity_mah * (1.0 - config_.full_charge_rearm_percent / 100.0); // 低于此剩余容量才允许再次判定满充
+  if (is_full_charge_latched_ && remaining_capacity_mah_ < rearm_capacity_mah) // 满充后已放出足够电量
+  {
+    is_full_charge_latched_ = false; // 允许下一次满充判定,电流/电压在阈值附近抖动不会重复触发
+  }
   if (sample_.bus_voltage_v > config_.full_charge_voltage_v && abs_current_ma < config_.full_charge_current_ma) // 充满电判断：电压高于满充电压且电流小于截止电流
   {
     remaining_capacity_mah_ = config_.battery_capacity_mah; // 设置为满容量
     soc_percent_ = 100.0f; // SoC设为100%
-    logf("Battery Charged. SoC reset to 100%%\n"); // 打印日志：电池已充满
-    maybe_save_to_nvs(now_ms, true); // 强制保存状态
+    if (!is_full_charge_latched_) // 每次满充只结算、记录和强制保存一次
+    {
+      is_full_charge_latched_ = true; // 标记已记录
+      learn_charge_efficiency_at_full_charge(); // 满充时结算一次充电效率学习
+      logf("Battery Charged. SoC reset to 100%%\n"); // 打印日志：电池已充满
+      record_event(BatteryEventType::FULL_CHARGE); // 记录事件：满充
+      maybe_save_to_nvs(now_ms, true); // 强制保存状态
+    }
   }
 
-  maybe_save_to_nvs(now_ms, false); // 尝试保存到NVS（非强制）
+  if (remaining_capacity_mah_ <= 0.0 && !is_depleted_latched_) // 剩余容量耗尽
+  {
+    is_depleted_latched_ = true; // 标记已记录
+    record_event(BatteryEventType::DEEP_DISCHARGE); // 记录事件：深度放电
+  }
+  else if (soc_percent_ > 5.0f) // SOC回升后允许下一次记录
+  {
+    is_depleted_latched_ = false; // 复位标记
+  }
 
-  sample_.remaining_capacity_mah = remaining_capacity_mah_; // 更新样本数据：剩余容量
-  sample_.soc_percent = soc_percent_; // 更新样本数据：SoC
+  maybe_recalibrate_at_rest(now_ms, abs_current_ma); // 静置足够久时按开路电压校准
 }
 
 const Ina226BatteryMonitor::Sample &Ina226BatteryMonitor::sample() const
 {
+  if (is_sample_dirty_) // 原始寄存器值尚未换算
+  {
+    refresh_sample_from_raw(); // 按需换算
+  }
   return sample_; // 返回样本成员变量
 }
 
+float Ina226BatteryMonitor::get_charge_efficiency() const
+{
+  return isnan(learned_charge_efficiency_) ? config_.charge_efficiency : learned_charge_efficiency_; // 优先使用学习值
+}
+
+void Ina226BatteryMonitor::set_epoch_ms(uint64_t epoch_ms)
+{
+  clock_.set_epoch_ms(epoch_ms, millis()); // 设置绝对时间
+  MonotonicClock::write_system_time(epoch_ms); // 同时写入系统时间,软件复位和深度睡眠后可恢复
+  logf("Clock set: epoch=%llu ms\n", static_cast<unsigned long long>(epoch_ms)); // 打印日志：时间已设置
+  if (is_off_period_pending_) // 启动时时间未知,补偿被推迟
+  {
+    apply_off_period_compensation(); // 现在补偿关机期间的变化
+  }
+}
+
+const Ina226BatteryMonitor::SampleGapStats &Ina226BatteryMonitor::get_sample_gap_stats() const
+{
+  return sample_gap_stats_; // 返回统计
+}
+
+void Ina226BatteryMonitor::reset_sample_gap_stats()
+{
+  sample_gap_stats_ = SampleGapStats{}; // 清零统计
+}
+
+const MonotonicClock &Ina226BatteryMonitor::get_clock() const
+{
+  return clock_; // 返回时间基准
+}
+
+uint8_t Ina226BatteryMonitor::get_protection_faults() const
+{
+  return protection_faults_; // 返回保护故障位
+}
+
+bool Ina226BatteryMonitor::is_load_enabled() const
+{
+  return is_load_enabled_; // 返回负载开关状态
+}
+
+void Ina226BatteryMonitor::clear_protection_faults()
+{
+  if (config_.alert_gpio >= 0) // 使用了硬件告警
+  {
+    ina226_.getAlertFlag(); // 读取屏蔽/使能寄存器以清除告警锁存
+  }
+  is_alert_tripped_ = false; // 清除中断触发标记
+  protection_faults_ = 0; // 清除全部故障
+  over_current_timer_.is_pending = false; // 复位计时器
+  under_voltage_timer_.is_pending = false; // 复位计时器
+  over_temperature_timer_.is_pending = false; // 复位计时器
+  release_timer_.is_pending = false; // 复位计时器
+  set_load_enabled(true); // 恢复负载
+  logf("Protection cleared\n"); // 打印日志：保护已清除
+  record_event(BatteryEventType::PROTECTION_CLEAR); // 记录事件：保护解除
+}
+
 void Ina226BatteryMonitor::reset_state_from_voltage(float voltage_v)
 {
-  soc_percent_ = get_soc_from_voltage(voltage_v); // 根据电压查表获取SOC
+  soc_percent_ = estimate_soc_from_voltage(voltage_v); // 根据电压查表获取SOC
   remaining_capacity_mah_ = (static_cast<double>(soc_percent_) / 100.0) * config_.battery_capacity_mah; // 根据SOC计算容量
 }
 
@@ -231,7 +657,7 @@ bool Ina226BatteryMonitor::is_nvs_enabled() const
          config_.nvs_key_state != nullptr && config_.nvs_key_state[0] != '\0'; // 检查键名是否有效
 }
 
-bool Ina226BatteryMonitor::load_remaining_capacity_from_nvs(double &out_remaining_capacity_mah) const
+bool Ina226BatteryMonitor::load_remaining_capacity_from_nvs(double &out_remaining_capacity_mah, float &out_learned_charge_efficiency, uint32_t &out_saved_epoch_s) const
 {
   if (!is_nvs_enabled()) // 如果NVS未启用
   {
@@ -245,10 +671,10 @@ bool Ina226BatteryMonitor::load_remaining_capacity_from_nvs(double &out_remainin
     return false; // 返回失败
   }
 
-  PersistedBatteryState state{}; // 定义电池状态结构体
-  const size_t expected_size = sizeof(state); // 获取预期的大小
+  uint8_t buffer[sizeof(PersistedBatteryState)] = {}; // 原始数据缓冲,兼容版本1的较短数据
+  const size_t expected_size = sizeof(PersistedBatteryState); // 获取预期的大小
   const size_t stored_size = prefs.getBytesLength(config_.nvs_key_state); // 获取存储的数据大小
-  if (stored_size != expected_size) // 如果存储大小不匹配
+  if (stored_size != expected_size && stored_size != k_battery_state_v1_size) // 如果存储大小不匹配
   {
     logf("NVS: Size mismatch (expected=%u, stored=%u)\n", // 打印日志：大小不匹配
          static_cast<unsigned int>(expected_size), // 预期大小
@@ -257,17 +683,28 @@ bool Ina226BatteryMonitor::load_remaining_capacity_from_nvs(double &out_remainin
     return false; // 返回失败
   }
 
-  const size_t read_size = prefs.getBytes(config_.nvs_key_state, &state, expected_size); // 读取数据到结构体
+  const size_t read_size = prefs.getBytes(config_.nvs_key_state, buffer, stored_size); // 读取原始数据
   prefs.end(); // 关闭Preferences
-  if (read_size != expected_size) // 如果读取的大小不匹配
+  if (read_size != stored_size) // 如果读取的大小不匹配
   {
     logf("NVS: Read size mismatch (expected=%u, read=%u)\n", // 打印日志：读取大小不匹配
-         static_cast<unsigned int>(expected_size), // 预期大小
+         static_cast<unsigned int>(stored_size), // 预期大小
          static_cast<unsigned int>(read_size)); // 实际读取大小
     return false; // 返回失败
   }
 
-  if (state.magic != k_battery_state_magic || state.version != k_battery_state_version) // 校验Magic数和版本号
+  const bool is_v1 = (stored_size == k_battery_state_v1_size); // 是否为版本1数据
+  const size_t crc_offset = stored_size - sizeof(uint32_t); // CRC总在末尾
+  PersistedBatteryState state{}; // 定义电池状态结构体
+  memcpy(&state, buffer, offsetof(PersistedBatteryState, saved_epoch_s)); // 两个版本的公共前缀
+  memcpy(&state.crc32, buffer + crc_offset, sizeof(state.crc32)); // 读取CRC
+  if (!is_v1) // 版本2带保存时间
+  {
+    memcpy(&state.saved_epoch_s, buffer + offsetof(PersistedBatteryState, saved_epoch_s), sizeof(state.saved_epoch_s)); // 读取保存时间
+  }
+
+  const uint16_t expected_version = is_v1 ? 1 : k_battery_state_version; // 按大小确定应有的版本号
+  if (state.magic != k_battery_state_magic || state.version != expected_version) // 校验Magic数和版本号
   {
     logf("NVS: Invalid Magic/Version (magic=0x%08X, ver=%u)\n", // 打印日志：无效的Magic或版本
          static_cast<unsigned int>(state.magic), // 读取的Magic
@@ -285,7 +722,7 @@ bool Ina226BatteryMonitor::load_remaining_capacity_from_nvs(double &out_remainin
   }
 
   const uint32_t expected_crc = // 计算校验和
-      calc_crc32_le(reinterpret_cast<const uint8_t *>(&state), offsetof(PersistedBatteryState, crc32)); // 计算除了CRC字段之外的数据的CRC32
+      calc_crc32_le(buffer, crc_offset); // 计算除了CRC字段之外的数据的CRC32
   if (state.crc32 != expected_crc) // 如果校验和不匹配
   {
     logf("NVS: CRC mismatch (expected=0x%08X, stored=0x%08X)\n", // 打印日志：CRC不匹配
@@ -295,6 +732,8 @@ bool Ina226BatteryMonitor::load_remaining_capacity_from_nvs(double &out_remainin
   }
 
   out_remaining_capacity_mah = static_cast<double>(state.remaining_mah_x100) / 100.0; // 将存储的容量（放大100倍）转换为实际值
+  out_saved_epoch_s = state.saved_epoch_s; // 上次保存时间,版本1或未知时为0
+  out_learned_charge_efficiency = state.learned_efficiency_x10000 > 0 ? static_cast<float>(state.learned_efficiency_x10000) / 10000.0f : NAN; // 0表示未学习
   return true; // 返回成功
 }
 
@@ -305,6 +744,11 @@ bool Ina226BatteryMonitor::save_remaining_capacity_to_nvs(double remaining_capac
     return false; // 返回失败
   }
 
+  return write_persisted_state(build_persisted_state(remaining_capacity_mah)); // 生成状态并写入
+}
+
+Ina226BatteryMonitor::PersistedBatteryState Ina226BatteryMonitor::build_persisted_state(double remaining_capacity_mah) const
+{
   if (remaining_capacity_mah < 0.0) // 如果剩余容量小于0
     remaining_capacity_mah = 0.0; // 限制为0
   if (remaining_capacity_mah > config_.battery_capacity_mah) // 如果剩余容量大于总容量
@@ -313,16 +757,20 @@ bool Ina226BatteryMonitor::save_remaining_capacity_to_nvs(double remaining_capac
   PersistedBatteryState state{}; // 初始化持久化状态结构体
   state.magic = k_battery_state_magic; // 设置Magic数
   state.version = k_battery_state_version; // 设置版本号
-  state.reserved = 0; // 保留字段置0
+  state.learned_efficiency_x10000 = isnan(learned_charge_efficiency_) ? 0 : static_cast<uint16_t>(learned_charge_efficiency_ * 10000.0f + 0.5f); // 保存学习到的充电效率
   state.capacity_mah_x1 = static_cast<uint32_t>(config_.battery_capacity_mah + 0.5f); // 设置电池容量
   state.remaining_mah_x100 = static_cast<uint32_t>(remaining_capacity_mah * 100.0 + 0.5); // 设置剩余容量（放大100倍保存）
+  state.saved_epoch_s = static_cast<uint32_t>(clock_.to_epoch_ms(last_update_monotonic_ms_) / 1000ULL); // 保存时间,绝对时间未知时为0
   state.crc32 = calc_crc32_le(reinterpret_cast<const uint8_t *>(&state), offsetof(PersistedBatteryState, crc32)); // 计算CRC校验和
+  return state; // 返回状态
+}
 
+bool Ina226BatteryMonitor::write_persisted_state(const PersistedBatteryState &state) const
+{
   Preferences prefs; // 创建Preferences对象
   if (!prefs.begin(config_.nvs_namespace, false)) // 以读写模式打开NVS命名空间
   {
-    logf("NVS: Failed to open namespace\n"); // 打印日志：打开失败
-    return false; // 返回失败
+    return false; // 返回失败,由调用者记录
   }
 
   const size_t written_size = prefs.putBytes(config_.nvs_key_state, &state, sizeof(state)); // 写入数据
@@ -339,6 +787,10 @@ float Ina226BatteryMonitor::get_soc_from_voltage(float voltage_v) const
     table = k_default_soc_table_; // 使用默认表格
     table_len = sizeof(k_default_soc_table_) / sizeof(k_default_soc_table_[0]); // 计算默认表格长度
   }
+  else if (config_.soc_table_cell_count > 1) // 自定义表格为单节电压时
+  {
+    voltage_v /= static_cast<float>(config_.soc_table_cell_count); // 换算为单节电压再查表
+  }
 
   if (voltage_v >= table[0].voltage_v) // 如果电压高于或等于最高电压点
     return table[0].soc_percent; // 返回对应的SOC（通常是100%）
@@ -361,49 +813,1036 @@ float Ina226BatteryMonitor::get_soc_from_voltage(float voltage_v) const
   return table[table_len - 1].soc_percent; // 默认返回最低SOC
 }
 
-void Ina226BatteryMonitor::maybe_save_to_nvs(uint32_t now_ms, bool force) 
+void Ina226BatteryMonitor::begin_protection()
 {
-  if (!is_nvs_enabled()) // 如果NVS未启用
+  if (config_.protection_gpio >= 0) // 配置了负载开关引脚
   {
-    return; // 直接返回
+    pinMode(config_.protection_gpio, OUTPUT); // 设置为输出
+    set_load_enabled(true); // 默认接通负载
   }
 
-  if (!force && (now_ms - last_nvs_save_ms_) < config_.save_interval_ms) // 如果非强制保存且未到保存间隔
+  if (config_.alert_gpio < 0 || config_.over_current_ma <= 0.0f) // 未使用硬件告警或未启用过流保护
   {
     return; // 直接返回
   }
 
-  if (!force && !isnan(last_saved_remaining_capacity_mah_) && // 检查上次保存值是否有效
-      fabs(remaining_capacity_mah_ - last_saved_remaining_capacity_mah_) < config_.min_save_delta_mah) // 检查变化量
+  const float limit_lsb = (config_.over_current_ma / 1000.0f) * config_.shunt_resistor_ohm / 2.5e-6f; // 分流电压告警阈值,LSB为2.5uV
+  const int32_t limit_raw = static_cast<int32_t>(limit_lsb > 32767.0f ? 32767.0f : limit_lsb); // 限制在寄存器范围内
+  if (config_.current_polarity >= 0) // 放电时分流电压为正
   {
-    last_nvs_save_ms_ = now_ms; // 更新上次尝试保存的时间
-    return; // 直接返回
+    ina226_.setAlertLimit(static_cast<uint16_t>(limit_raw)); // 设置正向阈值
+    ina226_.setAlertRegister(INA226_SHUNT_OVER_VOLTAGE | INA226_ALERT_LATCH_ENABLE_FLAG); // 分流过压告警并锁存
+  }
+  else
+  {
+    ina226_.setAlertLimit(static_cast<uint16_t>(-limit_raw)); // 设置负向阈值(补码)
+    ina226_.setAlertRegister(INA226_SHUNT_UNDER_VOLTAGE | INA226_ALERT_LATCH_ENABLE_FLAG); // 分流欠压告警并锁存
   }
 
-  if (save_remaining_capacity_to_nvs(remaining_capacity_mah_)) // 尝试执行保存
+  if (config_.protection_gpio >= 0) // 中断中直接写输出寄存器,预先计算引脚位
   {
-    last_saved_remaining_capacity_mah_ = remaining_capacity_mah_; // 更新上次保存的容量值
-    last_nvs_save_ms_ = now_ms; // 更新保存时间
-    logf("NVS saved: remaining=%.2f mAh (SoC %.1f%%)\n", remaining_capacity_mah_, soc_percent_); // 打印日志：保存成功
+    is_load_gpio_high_bank_ = config_.protection_gpio >= 32; // GPIO32-39位于第二组寄存器
+    load_gpio_mask_ = 1UL << (config_.protection_gpio & 31); // 引脚位
   }
-  else
+
+  pinMode(config_.alert_gpio, INPUT_PULLUP); // ALERT为开漏低有效输出
+  const esp_err_t service_err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM); // 安装IRAM中断服务,Flash擦写期间仍可响应
+  if (service_err != ESP_OK && service_err != ESP_ERR_INVALID_STATE) // 已安装时返回INVALID_STATE
   {
-    logf("NVS save failed\n"); // 打印日志：保存失败
-    last_nvs_save_ms_ = now_ms; // 即使失败也更新时间
+    logf("ALERT: ISR service install failed (%d)\n", static_cast<int>(service_err)); // 打印日志：中断服务安装失败
+    return; // 只依赖软件保护
+  }
+  if (service_err == ESP_ERR_INVALID_STATE) // 中断服务已由其他模块安装,标志可能不含IRAM
+  {
+    logf("ALERT: ISR service already installed, flash-safe only if installed with ESP_INTR_FLAG_IRAM\n"); // 打印日志：提示
   }
+  gpio_set_intr_type(static_cast<gpio_num_t>(config_.alert_gpio), GPIO_INTR_NEGEDGE); // 下降沿触发中断
+  gpio_isr_handler_add(static_cast<gpio_num_t>(config_.alert_gpio), on_alert_interrupt, this); // 注册中断处理函数
 }
 
-void Ina226BatteryMonitor::logf(const char *format, ...) const 
+void Ina226BatteryMonitor::update_protection(uint32_t now_ms, bool is_over_current, bool is_under_voltage, bool is_under_voltage_released)
 {
-  if (logger_ == nullptr) // 如果日志对象未设置
+  if (is_alert_tripped_ && (protection_faults_ & PROTECTION_FAULT_OVER_CURRENT) == 0) // 硬件快速路径已断开负载
   {
-    return; // 直接返回
+    protection_faults_ |= PROTECTION_FAULT_OVER_CURRENT; // 记录过流故障
+    is_load_enabled_ = false; // 同步负载状态
+    logf("Protection: over-current (hardware alert)\n"); // 打印日志：硬件过流
+    record_event(BatteryEventType::PROTECTION_TRIP, PROTECTION_FAULT_OVER_CURRENT); // 记录事件：保护触发
   }
 
-  char buffer[128]; // 定义缓冲区
-  va_list args; // 定义可变参数列表
-  va_start(args, format); // 初始化可变参数
-  vsnprintf(buffer, sizeof(buffer), format, args); // 格式化字符串到缓冲区
-  va_end(args); // 结束可变参数处理
-  logger_->print(buffer); // 输出日志
+  if (config_.over_current_ma > 0.0f) // 启用过流保护
+  {
+    evaluate_protection(over_current_timer_, PROTECTION_FAULT_OVER_CURRENT, is_over_current, !is_over_current && !is_alert_tripped_, // 硬件告警需手动清除
+                        config_.over_current_delay_ms, config_.is_over_current_latched, now_ms);
+  }
+  if (config_.under_voltage_v > 0.0f) // 启用欠压保护
+  {
+    evaluate_protection(under_voltage_timer_, PROTECTION_FAULT_UNDER_VOLTAGE, is_under_voltage, is_under_voltage_released, // 低于阈值触发,高于阈值加回差解除
+                        config_.under_voltage_delay_ms, false, now_ms);
+  }
+  if (!isnan(config_.over_temperature_c) && !isnan(sample_.temperature_c)) // 启用过温保护且有温度数据
+  {
+    evaluate_protection(over_temperature_timer_, PROTECTION_FAULT_OVER_TEMPERATURE, sample_.temperature_c > config_.over_temperature_c, // 高于阈值触发
+                        sample_.temperature_c <= config_.over_temperature_c - config_.over_temperature_hysteresis_c, // 低于阈值减回差解除
+                        config_.over_temperature_delay_ms, false, now_ms);
+  }
+
+  if (protection_faults_ != 0) // 存在故障
+  {
+    release_timer_.is_pending = false; // 复位恢复计时
+    set_load_enabled(false); // 保持负载断开
+  }
+  else if (!is_load_enabled_) // 故障已全部解除但负载仍断开
+  {
+    if (!release_timer_.is_pending) // 开始恢复计时
+    {
+      release_timer_.is_pending = true; // 标记计时中
+      release_timer_.since_ms = now_ms; // 记录开始时间
+    }
+    else if ((now_ms - release_timer_.since_ms) >= config_.protection_release_delay_ms) // 恢复延时到达
+    {
+      release_timer_.is_pending = false; // 结束计时
+      set_load_enabled(true); // 恢复负载
+      logf("Protection released, load enabled\n"); // 打印日志：恢复负载
+      record_event(BatteryEventType::PROTECTION_CLEAR); // 记录事件：保护解除
+    }
+  }
+
+  sample_.protection_faults = protection_faults_; // 更新样本数据：保护故障位
+}
+
+void Ina226BatteryMonitor::update_raw_thresholds()
+{
+  current_lsb_ma_ = ina226_.getCurrentLSB_mA(); // 当前校准下的电流LSB
+  if (current_lsb_ma_ <= 0.0f) // 未校准
+  {
+    return; // 保留原阈值
+  }
+  raw_deadzone_ = static_cast<int32_t>(ceilf(config_.current_deadzone_ma / current_lsb_ma_)); // 死区换算为LSB
+  const float over_current_lsb = config_.over_current_ma / current_lsb_ma_; // 过流阈值换算为LSB
+  raw_over_current_ = over_current_lsb > 32767.0f ? 32767 : static_cast<int32_t>(over_current_lsb); // 限制在寄存器范围内
+  raw_under_voltage_ = static_cast<uint16_t>(config_.under_voltage_v / k_bus_voltage_lsb_v); // 欠压阈值换算为LSB
+  raw_under_voltage_release_ = static_cast<uint16_t>((config_.under_voltage_v + config_.under_voltage_hysteresis_v) / k_bus_voltage_lsb_v); // 欠压解除阈值换算为LSB
+}
+
+bool Ina226BatteryMonitor::update_raw(uint32_t now_ms)
+{
+  if (is_register_read_due(config_.bus_voltage_read_divider)) // 总线电压按分频读取
+  {
+    raw_bus_voltage_ = ina226_.getRegister(INA226_BUS_VOLTAGE); // 读取总线电压寄存器
+  }
+  is_raw_shunt_voltage_fresh_ = is_range_settling_ || is_register_read_due(config_.shunt_voltage_read_divider); // 分流电压按分频读取,切换量程后必须读取
+  if (is_raw_shunt_voltage_fresh_)
+  {
+    raw_shunt_voltage_ = static_cast<int16_t>(ina226_.getRegister(INA226_SHUNT_VOLTAGE)); // 读取分流电压寄存器
+  }
+  if (is_range_settling_) // 刚切换量程,电流寄存器尚未按新校准更新
+  {
+    const float shunt_current_lsb = raw_shunt_voltage_ * k_shunt_voltage_lsb_mv / config_.shunt_resistor_ohm / current_lsb_ma_; // 由分流电压推算电流(新LSB)
+    raw_current_ = static_cast<int16_t>(shunt_current_lsb > 32767.0f ? 32767.0f : (shunt_current_lsb < -32768.0f ? -32768.0f : lroundf(shunt_current_lsb))); // 限制在寄存器范围内
+    is_range_settling_ = false; // 下一次恢复读取电流寄存器
+  }
+  else
+  {
+    raw_current_ = static_cast<int16_t>(ina226_.getRegister(INA226_CURRENT)); // 读取电流寄存器,每次都读
+  }
+  is_raw_power_fresh_ = is_register_read_due(config_.power_read_divider); // 功率按分频读取
+  if (is_raw_power_fresh_)
+  {
+    raw_power_ = ina226_.getRegister(INA226_POWER); // 读取功率寄存器
+  }
+  register_read_cycle_++; // 推进调度计数
+  is_sample_dirty_ = true; // 样本字段待换算
+
+  const int32_t signed_current = config_.current_polarity < 0 ? -static_cast<int32_t>(raw_current_) : raw_current_; // 应用极性,放电为正
+  const int32_t abs_current = signed_current < 0 ? -signed_current : signed_current; // 电流绝对值(LSB)
+  const uint32_t elapsed_ms = now_ms - last_raw_sample_ms_; // 距上次采样的时间
+  last_raw_sample_ms_ = now_ms; // 更新采样时间
+  if (config_.enable_dual_shunt) // 双分流模式:低量程分辨率高于本通道LSB,按mA累加
+  {
+    merged_current_ma_ = merge_dual_shunt_current(static_cast<float>(signed_current) * current_lsb_ma_); // 与低量程通道合并
+    if (fabsf(merged_current_ma_) >= config_.current_deadzone_ma) // 死区外才累加
+    {
+      raw_pending_charge_ma_ms_ += static_cast<double>(merged_current_ma_) * elapsed_ms; // 浮点积分
+    }
+  }
+  else if (abs_current >= raw_deadzone_) // 死区外才累加
+  {
+    raw_charge_accumulator_ += static_cast<int64_t>(signed_current) * elapsed_ms; // 整数积分
+  }
+  raw_accumulated_ms_ += elapsed_ms; // 累计时长
+
+  update_protection(now_ms, abs_current > raw_over_current_, raw_bus_voltage_ < raw_under_voltage_, // 整数阈值比较
+                    raw_bus_voltage_ >= raw_under_voltage_release_);
+  update_auto_range(now_ms, static_cast<float>(abs_current) * current_lsb_ma_); // 按电流切换量程
+
+  if ((now_ms - last_raw_fold_ms_) < config_.raw_fold_interval_ms) // 未到折算周期
+  {
+    return false; // 跳过浮点处理
+  }
+  last_raw_fold_ms_ = now_ms; // 更新折算时间
+  return true; // 需要浮点处理
+}
+
+float Ina226BatteryMonitor::merge_dual_shunt_current(float high_range_current_ma)
+{
+  const float low_range_current_ma = static_cast<float>(config_.current_polarity) * low_range_ina226_.getCurrent_mA(); // 读取低量程电流并应用极性
+  const float abs_low_ma = fabsf(low_range_current_ma); // 低量程电流绝对值
+  const float low_range_max_ma = config_.low_range_shunt_max_current_amps * 1000.0f; // 低量程最大电流(mA)
+  const bool is_saturated = abs_low_ma >= low_range_max_ma || // 超出低量程
+                            abs_low_ma * config_.low_range_shunt_resistor_ohm >= k_shunt_voltage_saturation_mv; // 分流电压接近ADC满量程
+
+  float low_weight = 0.0f; // 低量程权重
+  if (!is_saturated) // 低量程有效
+  {
+    const float start_ma = low_range_max_ma * config_.dual_shunt_crossfade_start_percent / 100.0f; // 过渡起点(mA)
+    const float end_ma = low_range_max_ma * config_.dual_shunt_crossfade_end_percent / 100.0f; // 过渡终点(mA)
+    if (abs_low_ma <= start_ma) // 小电流区
+    {
+      low_weight = 1.0f; // 完全使用低量程
+    }
+    else if (abs_low_ma < end_ma && end_ma > start_ma) // 过渡区
+    {
+      low_weight = (end_ma - abs_low_ma) / (end_ma - start_ma); // 线性交叉淡化
+    }
+  }
+
+  sample_.low_range_weight = low_weight; // 更新样本数据：低量程权重
+  return low_weight * low_range_current_ma + (1.0f - low_weight) * high_range_current_ma; // 加权合并
+}
+
+void Ina226BatteryMonitor::update_auto_range(uint32_t now_ms, float abs_current_ma)
+{
+  if (!config_.enable_auto_range || is_range_settling_) // 未启用或刚切换
+  {
+    return; // 直接返回
+  }
+
+  const float low_range_max_ma = config_.low_range_max_current_amps * 1000.0f; // 低量程最大电流(mA)
+  if (is_low_range_active_) // 低量程
+  {
+    if (abs_current_ma >= low_range_max_ma * config_.auto_range_up_percent / 100.0f) // 接近饱和
+    {
+      switch_current_range(false); // 立即切换到满量程
+    }
+    return; // 直接返回
+  }
+
+  if (abs_current_ma >= low_range_max_ma * config_.auto_range_down_percent / 100.0f) // 电流仍然较大
+  {
+    is_range_down_pending_ = false; // 复位计时
+    return; // 直接返回
+  }
+  if (!is_range_down_pending_) // 开始计时
+  {
+    is_range_down_pending_ = true; // 标记计时中
+    range_down_since_ms_ = now_ms; // 记录开始时间
+  }
+  else if ((now_ms - range_down_since_ms_) >= config_.auto_range_down_hold_ms) // 持续低电流
+  {
+    is_range_down_pending_ = false; // 结束计时
+    switch_current_range(true); // 切换到低量程
+  }
+}
+
+void Ina226BatteryMonitor::switch_current_range(bool is_low_range)
+{
+  raw_pending_charge_ma_ms_ += static_cast<double>(raw_charge_accumulator_) * current_lsb_ma_; // 按旧LSB折算整数累加器
+  raw_charge_accumulator_ = 0; // 清零累加器
+
+  const float max_current_amps = is_low_range ? config_.low_range_max_current_amps : config_.max_current_amps; // 目标量程
+  ina226_.setMaxCurrentShunt(max_current_amps, config_.shunt_resistor_ohm); // 改写校准寄存器
+  update_raw_thresholds(); // 整数阈值随LSB更新
+  is_low_range_active_ = is_low_range; // 记录当前量程
+  is_range_settling_ = true; // 下一次采样改用分流电压推算电流
+  logf("Auto range: %s (LSB %s mA)\n", is_low_range ? "low" : "full", FixedPointText(current_lsb_ma_, 4).c_str()); // 打印日志：量程切换
+}
+
+bool Ina226BatteryMonitor::is_register_read_due(uint8_t divider) const
+{
+  return divider != 0 && (register_read_cycle_ % divider) == 0; // 首次更新总是读取
+}
+
+float Ina226BatteryMonitor::fold_raw_charge()
+{
+  const float average_current_ma = raw_accumulated_ms_ > 0 ? // 折算周期内的平均电流(含量程切换前按旧LSB折算的部分)
+      static_cast<float>((raw_pending_charge_ma_ms_ + static_cast<double>(raw_charge_accumulator_) * current_lsb_ma_) / raw_accumulated_ms_) : 0.0f;
+  raw_charge_accumulator_ = 0; // 清零累加器
+  raw_pending_charge_ma_ms_ = 0.0; // 清零已折算电荷
+  raw_accumulated_ms_ = 0; // 清零累计时长
+  return average_current_ma; // 返回平均电流
+}
+
+void Ina226BatteryMonitor::refresh_sample_from_raw() const
+{
+  sample_.bus_voltage_v = raw_bus_voltage_ * k_bus_voltage_lsb_v; // 换算总线电压
+  const float register_current_ma = raw_current_ * current_lsb_ma_; // 换算电流寄存器(未应用极性)
+  sample_.current_ma = config_.enable_dual_shunt ? merged_current_ma_ : static_cast<float>(config_.current_polarity) * register_current_ma; // 应用极性,双分流时使用合并电流
+  sample_.power2_mw = sample_.bus_voltage_v * fabsf(sample_.current_ma); // 计算功率（电压*电流绝对值）,双分流时为合并电流
+  sample_.shunt_voltage_mv = is_raw_shunt_voltage_fresh_ ? raw_shunt_voltage_ * k_shunt_voltage_lsb_mv : // 换算分流电压
+                                                           register_current_ma * config_.shunt_resistor_ohm; // 未读取时由电流推算
+  sample_.power_mw = is_raw_power_fresh_ ? raw_power_ * current_lsb_ma_ * 25.0f : sample_.power2_mw; // 功率LSB为电流LSB的25倍,未读取时由电压*电流推算
+  is_sample_dirty_ = false; // 已换算
+}
+
+void Ina226BatteryMonitor::evaluate_protection(ProtectionTimer &timer, uint8_t fault, bool is_tripping, bool is_releasing, uint32_t trip_delay_ms, bool is_latched, uint32_t now_ms)
+{
+  if (is_tripping) // 满足触发条件
+  {
+    if ((protection_faults_ & fault) != 0) // 已经触发
+    {
+      return; // 保持故障
+    }
+    if (!timer.is_pending) // 开始触发计时
+    {
+      timer.is_pending = true; // 标记计时中
+      timer.since_ms = now_ms; // 记录开始时间
+    }
+    if ((now_ms - timer.since_ms) >= trip_delay_ms) // 持续时间达到触发延时
+    {
+      timer.is_pending = false; // 结束计时
+      protection_faults_ |= fault; // 记录故障
+      set_load_enabled(false); // 立即断开负载
+      logf("Protection trip: fault=0x%02X, V=%s, I=%s\n", static_cast<unsigned int>(fault), FixedPointText(sample_.bus_voltage_v, 3).c_str(), FixedPointText(sample_.current_ma, 1).c_str()); // 打印日志：保护触发
+      record_event(BatteryEventType::PROTECTION_TRIP, fault); // 记录事件：保护触发
+    }
+    return; // 返回
+  }
+
+  timer.is_pending = false; // 条件消失,复位触发计时
+  if (is_releasing && !is_latched) // 满足解除条件且不锁存
+  {
+    protection_faults_ &= static_cast<uint8_t>(~fault); // 清除故障位
+  }
+}
+
+void Ina226BatteryMonitor::set_load_enabled(bool is_enabled)
+{
+  is_load_enabled_ = is_enabled; // 记录负载状态
+  if (config_.protection_gpio < 0) // 未配置负载开关引脚
+  {
+    return; // 仅记录状态
+  }
+  const bool is_level_high = (is_enabled == config_.is_load_on_level_high); // 计算输出电平
+  digitalWrite(config_.protection_gpio, is_level_high ? HIGH : LOW); // 驱动负载开关
+}
+
+void IRAM_ATTR Ina226BatteryMonitor::on_alert_interrupt(void *arg)
+{
+  Ina226BatteryMonitor *monitor = static_cast<Ina226BatteryMonitor *>(arg); // 取回实例指针
+  monitor->is_alert_tripped_ = true; // 标记硬件过流
+  if (monitor->load_gpio_mask_ != 0) // 配置了负载开关引脚
+  {
+    const bool is_off_level_high = !monitor->config_.is_load_on_level_high; // 断开负载的电平
+    const uint32_t reg = monitor->is_load_gpio_high_bank_ ? (is_off_level_high ? GPIO_OUT1_W1TS_REG : GPIO_OUT1_W1TC_REG) : // GPIO32-39
+                                                            (is_off_level_high ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG); // GPIO0-31
+    REG_WRITE(reg, monitor->load_gpio_mask_); // 直接写寄存器立即断开负载(digitalWrite不在IRAM中)
+  }
+}
+
+bool Ina226BatteryMonitor::measure_startup_voltage_hw_average(float &out_voltage_v)
+{
+  const uint8_t average = config_.startup_hw_average <= INA226_1024_SAMPLES ? config_.startup_hw_average : static_cast<uint8_t>(INA226_1024_SAMPLES); // 限制在枚举范围内
+  const uint8_t conversion_time = config_.startup_hw_conversion_time <= INA226_8300_us ? config_.startup_hw_conversion_time : static_cast<uint8_t>(INA226_8300_us); // 限制在枚举范围内
+  const uint32_t timeout_ms = get_ina226_conversion_timeout_ms(get_ina226_conversion_us(average, conversion_time)); // 超时留出两倍裕量(内部时钟误差)
+
+  const uint8_t runtime_bus_conversion_time = ina226_.getBusVoltageConversionTime(); // 保存运行时的总线转换时间
+  ina226_.setAverage(average); // 设置启动平均点数
+  ina226_.setBusVoltageConversionTime(conversion_time); // 设置启动转换时间
+  const bool is_triggered = ina226_.setModeBusTrigger(); // 写配置寄存器触发一次总线电压转换(同时清除转换就绪标志)
+  const bool is_ready = is_triggered && ina226_.waitConversionReady(timeout_ms); // 等待转换完成
+  if (is_ready) // 转换完成
+  {
+    out_voltage_v = ina226_.getBusVoltage(); // 读取平均后的总线电压
+  }
+
+  ina226_.setAverage(config_.average); // 恢复运行时平均点数
+  ina226_.setBusVoltageConversionTime(runtime_bus_conversion_time); // 恢复运行时转换时间
+  ina226_.setModeShuntBusContinuous(); // 恢复连续转换
+  if (!is_ready) // 转换失败
+  {
+    logf("Startup hw average timed out, falling back to sw loop\n"); // 打印日志：退回软件循环
+  }
+  return is_ready; // 返回结果
+}
+
+float Ina226BatteryMonitor::estimate_soc_from_voltage(float pack_voltage_v) const
+{
+  if (cell_monitor_ != nullptr && cell_monitor_->has_valid_scan()) // 有有效的单节数据
+  {
+    const float weakest_pack_v = cell_monitor_->get_min_cell_voltage_v() * static_cast<float>(cell_monitor_->get_cell_count()); // 假设每节都与最弱单节相同时的整包电压
+    return get_soc_from_voltage(weakest_pack_v); // 以最弱单节估算,避免整包电压掩盖弱单节
+  }
+  return get_soc_from_voltage(pack_voltage_v); // 按整包电压估算
+}
+
+void Ina226BatteryMonitor::update_cell_voltages(uint32_t now_ms)
+{
+  if (cell_monitor_ == nullptr) // 未挂接单节电压监视器
+  {
+    return; // 直接返回
+  }
+
+  cell_monitor_->update(now_ms); // 到达扫描周期后每次推进一个抽头,不长时间占用总线
+  if (!cell_monitor_->has_valid_scan()) // 无有效扫描结果
+  {
+    sample_.min_cell_voltage_v = NAN; // 清除单节统计
+    sample_.max_cell_voltage_v = NAN; // 清除单节统计
+    sample_.cell_imbalance_mv = NAN; // 清除单节统计
+    sample_.weakest_cell_soc_percent = NAN; // 清除单节统计
+    return; // 直接返回
+  }
+
+  sample_.min_cell_voltage_v = cell_monitor_->get_min_cell_voltage_v(); // 最低单节电压
+  sample_.max_cell_voltage_v = cell_monitor_->get_max_cell_voltage_v(); // 最高单节电压
+  sample_.cell_imbalance_mv = cell_monitor_->get_imbalance_mv(); // 单节压差
+  sample_.weakest_cell_soc_percent = estimate_soc_from_voltage(sample_.bus_voltage_v); // 最弱单节SOC
+}
+
+void Ina226BatteryMonitor::update_temperature(uint32_t now_ms)
+{
+  if (temperature_source_ == nullptr) // 未挂接温度源
+  {
+    return; // 直接返回
+  }
+
+  float temperature_c = NAN; // 本次测量结果
+  if (temperature_source_->poll(temperature_c)) // 推进测量,完成时得到温度
+  {
+    sample_.temperature_c = temperature_c; // 更新样本数据：温度
+    const float capacity_factor = interpolate_temperature_factor(config_.capacity_temp_table, config_.capacity_temp_table_len, temperature_c); // 有效容量系数
+    capacity_temp_factor_ = capacity_factor > 0.0f ? capacity_factor : 1.0f; // 系数无效时不修正
+    const float charge_factor = interpolate_temperature_factor(config_.charge_efficiency_temp_table, config_.charge_efficiency_temp_table_len, temperature_c); // 充电效率系数
+    charge_temp_factor_ = charge_factor > 0.0f ? charge_factor : 1.0f; // 系数无效时不修正
+  }
+
+  if ((now_ms - last_temperature_request_ms_) >= config_.temperature_interval_ms) // 到达测量周期
+  {
+    temperature_source_->start_measurement(); // 发起新的测量
+    last_temperature_request_ms_ = now_ms; // 记录发起时间
+  }
+}
+
+float Ina226BatteryMonitor::interpolate_temperature_factor(const TemperatureFactorPoint *table, size_t table_len, float temperature_c)
+{
+  if (table == nullptr || table_len == 0 || isnan(temperature_c)) // 查表为空或温度无效
+  {
+    return 1.0f; // 不修正
+  }
+  if (temperature_c <= table[0].temperature_c) // 低于最低温度点
+    return table[0].factor; // 取最低温度点
+  if (temperature_c >= table[table_len - 1].temperature_c) // 高于最高温度点
+    return table[table_len - 1].factor; // 取最高温度点
+
+  for (size_t i = 0; i + 1 < table_len; i++) // 遍历表格区间
+  {
+    if (temperature_c <= table[i + 1].temperature_c) // 找到所在区间
+    {
+      const float span = table[i + 1].temperature_c - table[i].temperature_c; // 区间宽度
+      const float ratio = span > 0.0f ? (temperature_c - table[i].temperature_c) / span : 0.0f; // 区间内位置
+      return table[i].factor + ratio * (table[i + 1].factor - table[i].factor); // 线性插值
+    }
+  }
+
+  return table[table_len - 1].factor; // 默认取最高温度点
+}
+
+void Ina226BatteryMonitor::maybe_save_to_nvs(uint32_t now_ms, bool force) 
+{
+  if (!is_nvs_enabled()) // 如果NVS未启用
+  {
+    return; // 直接返回
+  }
+
+  if (!force && (now_ms - last_nvs_save_ms_) < config_.save_interval_ms) // 如果非强制保存且未到保存间隔
+  {
+    return; // 直接返回
+  }
+
+  if (!force && !isnan(last_saved_remaining_capacity_mah_) && // 检查上次保存值是否有效
+      fabs(remaining_capacity_mah_ - last_saved_remaining_capacity_mah_) < config_.min_save_delta_mah) // 检查变化量
+  {
+    last_nvs_save_ms_ = now_ms; // 更新上次尝试保存的时间
+    return; // 直接返回
+  }
+
+  last_nvs_save_ms_ = now_ms; // 无论结果如何都更新保存时间
+  if (nvs_writer_task_ != nullptr) // 后台写入:只投递状态,结果由collect_nvs_save_result()处理
+  {
+    const PersistedBatteryState state = build_persisted_state(remaining_capacity_mah_); // 生成状态
+    portENTER_CRITICAL(&nvs_writer_lock_); // 进入临界区
+    nvs_pending_state_ = state; // 覆盖尚未写入的旧状态
+    has_nvs_pending_state_ = true; // 标记待写入
+    portEXIT_CRITICAL(&nvs_writer_lock_); // 退出临界区
+    xTaskNotifyGive(nvs_writer_task_); // 唤醒写入任务
+    return; // 不等待写入完成
+  }
+
+  const uint32_t save_start_us = micros(); // 记录保存开始时间
+  const bool is_saved = save_remaining_capacity_to_nvs(remaining_capacity_mah_); // 尝试执行保存
+  finish_nvs_save(is_saved, micros() - save_start_us, remaining_capacity_mah_); // 处理结果
+}
+
+bool Ina226BatteryMonitor::start_nvs_writer()
+{
+  return xTaskCreate(nvs_writer_task, "nvs_writer", k_nvs_writer_stack_size, this, k_nvs_writer_priority, &nvs_writer_task_) == pdPASS; // 创建写入任务
+}
+
+void Ina226BatteryMonitor::nvs_writer_task(void *arg)
+{
+  Ina226BatteryMonitor *monitor = static_cast<Ina226BatteryMonitor *>(arg); // 取回实例指针
+  for (;;) // 常驻
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // 等待投递
+    portENTER_CRITICAL(&monitor->nvs_writer_lock_); // 进入临界区
+    const bool has_state = monitor->has_nvs_pending_state_; // 是否有待写入的状态
+    const PersistedBatteryState state = monitor->nvs_pending_state_; // 复制状态,写入期间允许新的投递
+    monitor->has_nvs_pending_state_ = false; // 清除标记
+    portEXIT_CRITICAL(&monitor->nvs_writer_lock_); // 退出临界区
+    if (!has_state) // 多次通知合并为一次
+    {
+      continue; // 继续等待
+    }
+
+    const uint32_t start_us = micros(); // 记录写入开始时间
+    const bool is_saved = monitor->write_persisted_state(state); // 打开命名空间、写入并提交,只有其中的Flash操作会让采样停顿
+    const uint32_t elapsed_us = micros() - start_us; // 写入耗时
+    portENTER_CRITICAL(&monitor->nvs_writer_lock_); // 进入临界区
+    monitor->has_nvs_result_ = true; // 标记有结果
+    monitor->is_nvs_result_saved_ = is_saved; // 写入结果
+    monitor->nvs_result_us_ = elapsed_us; // 写入耗时
+    monitor->nvs_result_remaining_mah_x100_ = state.remaining_mah_x100; // 写入的剩余容量
+    portEXIT_CRITICAL(&monitor->nvs_writer_lock_); // 退出临界区
+  }
+}
+
+void Ina226BatteryMonitor::collect_nvs_save_result()
+{
+  if (nvs_writer_task_ == nullptr) // 同步写入时结果已处理
+  {
+    return; // 直接返回
+  }
+
+  portENTER_CRITICAL(&nvs_writer_lock_); // 进入临界区
+  const bool has_result = has_nvs_result_; // 是否有结果
+  const bool is_saved = is_nvs_result_saved_; // 写入结果
+  const uint32_t save_us = nvs_result_us_; // 写入耗时
+  const uint32_t saved_mah_x100 = nvs_result_remaining_mah_x100_; // 写入的剩余容量
+  has_nvs_result_ = false; // 清除标记
+  portEXIT_CRITICAL(&nvs_writer_lock_); // 退出临界区
+  if (has_result) // 写入已完成
+  {
+    finish_nvs_save(is_saved, save_us, static_cast<double>(saved_mah_x100) / 100.0); // 处理结果
+  }
+}
+
+void Ina226BatteryMonitor::finish_nvs_save(bool is_saved, uint32_t save_us, double saved_remaining_capacity_mah)
+{
+  sample_gap_stats_.last_nvs_save_us = save_us; // 记录保存耗时
+  if (save_us > sample_gap_stats_.max_nvs_save_us) // 更新最大耗时
+    sample_gap_stats_.max_nvs_save_us = save_us; // 记录最大耗时
+  if (is_saved) // 保存成功
+  {
+    last_saved_remaining_capacity_mah_ = saved_remaining_capacity_mah; // 更新上次保存的容量值
+    logf("NVS saved: remaining=%s mAh (SoC %s%%)\n", FixedPointText(static_cast<float>(saved_remaining_capacity_mah), 2).c_str(), // 打印日志：保存成功
+         FixedPointText(static_cast<float>(saved_remaining_capacity_mah / config_.battery_capacity_mah * 100.0), 1).c_str());
+  }
+  else
+  {
+    logf("NVS save failed\n"); // 打印日志：保存失败
+    record_event(BatteryEventType::NVS_SAVE_FAILED); // 记录事件：NVS保存失败
+  }
+}
+
+bool Ina226BatteryMonitor::restore_retained_state()
+{
+  const RetainedMonitorState &state = retained_state_; // RTC内存中的快照
+  if (state.magic != k_retained_state_magic || state.version != k_retained_state_version || // 校验魔数和版本号
+      state.size != sizeof(RetainedMonitorState)) // 校验结构体大小
+  {
+    return false; // 冷启动后内存为随机值
+  }
+
+  const uint32_t expected_crc = calc_crc32_le(reinterpret_cast<const uint8_t *>(&state), offsetof(RetainedMonitorState, crc32)); // 计算CRC32
+  if (state.crc32 != expected_crc) // 校验CRC
+  {
+    logf("Warm restart: snapshot CRC mismatch\n"); // 打印日志：快照损坏
+    return false; // 返回失败
+  }
+
+  if (state.capacity_mah != config_.battery_capacity_mah || state.shunt_resistor_ohm != config_.shunt_resistor_ohm) // 配置已变化(如OTA更新了参数)
+  {
+    logf("Warm restart: config changed, ignoring snapshot\n"); // 打印日志：配置不一致
+    return false; // 返回失败
+  }
+
+  clock_.resume(state.monotonic_ms, millis()); // 单调时间从复位前继续
+  remaining_capacity_mah_ = state.remaining_capacity_mah; // 恢复剩余容量
+  last_saved_remaining_capacity_mah_ = state.last_saved_remaining_capacity_mah; // 恢复上次保存的容量
+  cycle_charge_in_mah_ = state.cycle_charge_in_mah; // 恢复本循环充入电量
+  cycle_discharge_out_mah_ = state.cycle_discharge_out_mah; // 恢复本循环放出电量
+  learned_charge_efficiency_ = state.learned_charge_efficiency; // 恢复学习到的充电效率
+  runtime_predictor_.restore(state.filtered_current_ma, state.filtered_power_mw); // 恢复平滑电流与功率
+  protection_faults_ = state.protection_faults; // 恢复保护故障位
+  has_full_charge_reference_ = (state.flags & RETAINED_FLAG_FULL_CHARGE_REFERENCE) != 0; // 恢复满充参考标志
+  is_full_charge_latched_ = (state.flags & RETAINED_FLAG_FULL_CHARGE_LATCHED) != 0; // 恢复满充事件标志
+  is_depleted_latched_ = (state.flags & RETAINED_FLAG_DEPLETED_LATCHED) != 0; // 恢复耗尽事件标志
+  return true; // 恢复成功
+}
+
+void Ina226BatteryMonitor::save_retained_state() const
+{
+  RetainedMonitorState &state = retained_state_; // RTC内存中的快照
+  state.magic = k_retained_state_magic; // 设置魔数
+  state.version = k_retained_state_version; // 设置版本号
+  state.size = sizeof(RetainedMonitorState); // 设置结构体大小
+  state.capacity_mah = config_.battery_capacity_mah; // 配置指纹：电池总容量
+  state.shunt_resistor_ohm = config_.shunt_resistor_ohm; // 配置指纹：分流电阻
+  state.monotonic_ms = last_update_monotonic_ms_; // 最后一次积分的单调时间
+  state.remaining_capacity_mah = remaining_capacity_mah_; // 剩余容量
+  state.last_saved_remaining_capacity_mah = last_saved_remaining_capacity_mah_; // 上次保存的容量
+  state.cycle_charge_in_mah = cycle_charge_in_mah_; // 本循环充入电量
+  state.cycle_discharge_out_mah = cycle_discharge_out_mah_; // 本循环放出电量
+  state.learned_charge_efficiency = learned_charge_efficiency_; // 学习到的充电效率
+  state.filtered_current_ma = runtime_predictor_.get_filtered_current_ma(); // 平滑电流
+  state.filtered_power_mw = runtime_predictor_.get_filtered_power_mw(); // 平滑功率
+  state.protection_faults = protection_faults_; // 保护故障位
+  state.flags = (has_full_charge_reference_ ? RETAINED_FLAG_FULL_CHARGE_REFERENCE : 0) | // 满充参考标志
+                (is_full_charge_latched_ ? RETAINED_FLAG_FULL_CHARGE_LATCHED : 0) | // 满充事件标志
+                (is_depleted_latched_ ? RETAINED_FLAG_DEPLETED_LATCHED : 0); // 耗尽事件标志
+  state.reserved = 0; // 保留字段清零
+  state.crc32 = calc_crc32_le(reinterpret_cast<const uint8_t *>(&state), offsetof(RetainedMonitorState, crc32)); // 计算CRC32
+}
+
+void Ina226BatteryMonitor::apply_battery_preset()
+{
+  const BatteryChemistryProfile *profile = get_battery_chemistry_profile(config_.battery_preset); // 查找预设
+  if (profile == nullptr) // CUSTOM或无效预设
+  {
+    return; // 保留手动配置
+  }
+
+  const float cells = static_cast<float>(profile->cell_count); // 串联节数
+  config_.soc_table = profile->cell_ocv_table; // 使用预设的单节开路电压查表
+  config_.soc_table_len = profile->cell_ocv_table_len; // 查表长度
+  config_.soc_table_cell_count = profile->cell_count; // 查表时按节数换算
+  config_.full_charge_voltage_v = profile->full_charge_cell_voltage_v * cells; // 整包满充判定电压
+  config_.full_charge_current_ma = profile->full_charge_current_c_rate * config_.battery_capacity_mah; // 满充截止电流
+  config_.charge_efficiency = profile->charge_efficiency; // 充电效率
+  config_.peukert_exponent = profile->peukert_exponent; // Peukert指数
+  config_.self_discharge_percent_per_month = profile->self_discharge_percent_per_month; // 月自放电率
+  config_.rest_current_ma = profile->rest_current_c_rate * config_.battery_capacity_mah; // 静置电流上限
+  config_.rest_recalibration_ms = profile->rest_recalibration_ms; // 静置校准时间
+  config_.ocv_plateau_min_soc_percent = profile->ocv_plateau_min_soc_percent; // 平台区下限
+  config_.ocv_plateau_max_soc_percent = profile->ocv_plateau_max_soc_percent; // 平台区上限
+  config_.capacity_temp_table = profile->capacity_temp_table; // 温度-有效容量系数查表
+  config_.capacity_temp_table_len = profile->capacity_temp_table_len; // 查表长度
+  config_.charge_efficiency_temp_table = profile->charge_efficiency_temp_table; // 温度-充电效率系数查表
+  config_.charge_efficiency_temp_table_len = profile->charge_efficiency_temp_table_len; // 查表长度
+}
+
+void Ina226BatteryMonitor::apply_off_period_compensation()
+{
+  is_off_period_pending_ = false; // 每次启动只补偿一次
+  uint32_t off_time_s = 0; // 关机时长(秒)
+  if (!get_off_time_s(off_time_s)) // 时间倒退或跨度异常
+  {
+    logf("Off-period compensation skipped (saved=%lu)\n", static_cast<unsigned long>(saved_epoch_s_)); // 打印日志：跳过补偿
+    return; // 不补偿
+  }
+
+  const double correction_mah = -static_cast<double>(config_.battery_capacity_mah) * config_.self_discharge_percent_per_month / 100.0 * // 自放电损失
+                                static_cast<double>(off_time_s) / k_seconds_per_month * off_period_nvs_weight_; // 仲裁后只修正NVS所占的部分
+  remaining_capacity_mah_ += correction_mah; // 对当前容量施加修正(启动后的积分保持不变)
+  if (remaining_capacity_mah_ < 0.0) // 边界检查：小于0
+    remaining_capacity_mah_ = 0.0; // 修正为0
+  if (remaining_capacity_mah_ > config_.battery_capacity_mah) // 边界检查：大于总容量
+    remaining_capacity_mah_ = config_.battery_capacity_mah; // 修正为总容量
+  soc_percent_ = static_cast<float>((remaining_capacity_mah_ / config_.battery_capacity_mah) * 100.0); // 重新计算SOC
+  sample_.remaining_capacity_mah = remaining_capacity_mah_; // 更新样本数据：剩余容量
+  sample_.soc_percent = soc_percent_; // 更新样本数据：SOC
+  logf("Off-period compensation: off=%lu s, delta=%s mAh (SoC %s%%)\n", static_cast<unsigned long>(off_time_s), FixedPointText(static_cast<float>(correction_mah), 2).c_str(), FixedPointText(soc_percent_, 1).c_str()); // 打印日志：补偿结果
+}
+
+bool Ina226BatteryMonitor::get_off_time_s(uint32_t &out_off_time_s)
+{
+  if (saved_epoch_s_ == 0 || !clock_.has_epoch()) // 保存时间或当前时间未知
+  {
+    return false; // 返回失败
+  }
+
+  const uint64_t monotonic_ms = clock_.extend(millis()); // 当前单调时间
+  const uint64_t boot_epoch_s = (clock_.to_epoch_ms(monotonic_ms) - monotonic_ms) / 1000ULL; // 本次启动时刻的Unix时间(秒)
+  if (boot_epoch_s <= saved_epoch_s_ || (boot_epoch_s - saved_epoch_s_) > k_max_off_time_s) // 时间倒退或跨度异常
+  {
+    return false; // 返回失败
+  }
+
+  out_off_time_s = static_cast<uint32_t>(boot_epoch_s - saved_epoch_s_); // 关机时长(秒)
+  return true; // 返回成功
+}
+
+float Ina226BatteryMonitor::calc_ocv_confidence(float ocv_soc_percent, float boot_abs_current_ma, bool is_off_time_known, uint32_t off_time_s) const
+{
+  float confidence = 1.0f; // 初始置信度
+  if (boot_abs_current_ma > config_.rest_current_ma && boot_abs_current_ma > 0.0f) // 启动时带载,电压偏离开路电压
+  {
+    confidence *= config_.rest_current_ma / boot_abs_current_ma; // 电流越大置信度越低
+  }
+  if (ocv_soc_percent > config_.ocv_plateau_min_soc_percent && ocv_soc_percent < config_.ocv_plateau_max_soc_percent) // 落在平台区内,电压难以分辨SOC
+  {
+    confidence *= 0.25f; // 大幅降低置信度
+  }
+  if (!is_off_time_known) // 关机时长未知,无法判断电压是否弛豫
+  {
+    confidence *= 0.5f; // 按一半计
+  }
+  else if (config_.ocv_relaxation_time_s > 0 && off_time_s < config_.ocv_relaxation_time_s) // 关机时间短,电压尚未完全弛豫
+  {
+    confidence *= static_cast<float>(off_time_s) / static_cast<float>(config_.ocv_relaxation_time_s); // 按弛豫程度线性折算
+  }
+  return confidence; // 返回置信度
+}
+
+void Ina226BatteryMonitor::arbitrate_boot_soc(float ocv_soc_percent, float boot_abs_current_ma)
+{
+  uint32_t off_time_s = 0; // 关机时长(秒)
+  const bool is_off_time_known = get_off_time_s(off_time_s); // 关机时长是否已知
+  const float confidence = calc_ocv_confidence(ocv_soc_percent, boot_abs_current_ma, is_off_time_known, off_time_s); // 开路电压置信度
+  const float difference_percent = ocv_soc_percent - soc_percent_; // 开路电压与NVS恢复值之差
+
+  float ocv_weight = confidence * config_.ocv_blend_weight; // 默认按置信度融合
+  const bool is_implausible = fabsf(difference_percent) >= config_.soc_plausibility_threshold_percent; // NVS值是否不可信
+  if (is_implausible && confidence >= config_.ocv_override_min_confidence) // 相差过大且开路电压可信
+  {
+    ocv_weight = 1.0f; // 直接采用开路电压
+  }
+  if (ocv_weight > 1.0f) // 边界检查
+    ocv_weight = 1.0f; // 修正为1
+  if (ocv_weight < 0.0f) // 边界检查
+    ocv_weight = 0.0f; // 修正为0
+
+  const double ocv_remaining_mah = static_cast<double>(ocv_soc_percent) / 100.0 * config_.battery_capacity_mah; // 开路电压对应的容量
+  remaining_capacity_mah_ += ocv_weight * (ocv_remaining_mah - remaining_capacity_mah_); // 加权融合
+  soc_percent_ = static_cast<float>((remaining_capacity_mah_ / config_.battery_capacity_mah) * 100.0); // 重新计算SOC
+  off_period_nvs_weight_ = 1.0f - ocv_weight; // 推迟的自放电补偿只作用于NVS部分
+  logf("Boot SoC arbitration: OCV %s%%, confidence %s, weight %s -> SoC %s%%\n", FixedPointText(ocv_soc_percent, 1).c_str(), FixedPointText(confidence, 2).c_str(), // 打印日志：仲裁结果
+       FixedPointText(ocv_weight, 2).c_str(), FixedPointText(soc_percent_, 1).c_str());
+  if (is_implausible) // NVS与电压估算明显不一致
+  {
+    record_event(BatteryEventType::BOOT_SOC_ARBITRATED, static_cast<uint32_t>(ocv_weight * 10000.0f + 0.5f)); // 记录事件：启动SOC仲裁
+  }
+}
+
+void Ina226BatteryMonitor::maybe_recalibrate_at_rest(uint32_t now_ms, float abs_current_ma)
+{
+  if (config_.rest_recalibration_ms == 0) // 未启用静置校准
+  {
+    return; // 直接返回
+  }
+
+  if (abs_current_ma > config_.rest_current_ma) // 电流超过静置阈值
+  {
+    is_resting_ = false; // 退出静置状态
+    return; // 直接返回
+  }
+
+  if (!is_resting_) // 刚进入静置状态
+  {
+    is_resting_ = true; // 标记静置
+    is_rest_recalibrated_ = false; // 新的静置周期允许校准一次
+    rest_start_ms_ = now_ms; // 记录静置开始时间
+    return; // 等待静置时间到达
+  }
+
+  if (is_rest_recalibrated_ || (now_ms - rest_start_ms_) < config_.rest_recalibration_ms) // 已校准或静置时间不足
+  {
+    return; // 直接返回
+  }
+
+  is_rest_recalibrated_ = true; // 本次静置只处理一次
+  const float ocv_soc_percent = estimate_soc_from_voltage(sample_.bus_voltage_v); // 按开路电压估算SOC
+  if (ocv_soc_percent > config_.ocv_plateau_min_soc_percent && ocv_soc_percent < config_.ocv_plateau_max_soc_percent) // 落在平台区内,电压无法可靠分辨SOC
+  {
+    return; // 保留库仑计数结果
+  }
+
+  logf("Rest recalibration: SoC %s%% -> %s%%\n", FixedPointText(soc_percent_, 1).c_str(), FixedPointText(ocv_soc_percent, 1).c_str()); // 打印日志：静置校准
+  reset_state_from_voltage(sample_.bus_voltage_v); // 按开路电压重置状态
+  record_event(BatteryEventType::REST_RECALIBRATION); // 记录事件：静置校准
+  maybe_save_to_nvs(now_ms, true); // 强制保存
+}
+
+void Ina226BatteryMonitor::cap_soc_at_weakest_cell(uint32_t elapsed_ms, float abs_current_ma)
+{
+  const float weakest_soc_percent = sample_.weakest_cell_soc_percent; // 最弱单节SOC
+  if (config_.weakest_cell_soc_time_constant_s <= 0.0f || isnan(weakest_soc_percent)) // 未启用或无单节数据
+  {
+    return; // 直接返回
+  }
+  if (abs_current_ma > config_.rest_current_ma || weakest_soc_percent >= soc_percent_) // 带载时压降使估算偏低;只向下修正,向上由静置校准负责
+  {
+    return; // 直接返回
+  }
+  if (weakest_soc_percent > config_.ocv_plateau_min_soc_percent && weakest_soc_percent < config_.ocv_plateau_max_soc_percent) // 落在平台区内,电压无法可靠分辨SOC
+  {
+    return; // 保留库仑计数结果
+  }
+
+  const double dt_s = static_cast<double>(elapsed_ms) * 0.001; // 时间差转换为秒
+  const double alpha = dt_s / (config_.weakest_cell_soc_time_constant_s + dt_s); // 一阶收敛系数,单次电压噪声不会造成跳变
+  const double weakest_remaining_mah = static_cast<double>(weakest_soc_percent) / 100.0 * config_.battery_capacity_mah; // 最弱单节SOC对应的容量
+  remaining_capacity_mah_ += alpha * (weakest_remaining_mah - remaining_capacity_mah_); // 向最弱单节靠拢
+  soc_percent_ = static_cast<float>((remaining_capacity_mah_ / config_.battery_capacity_mah) * 100.0); // 重新计算SOC
+}
+
+void Ina226BatteryMonitor::update_runtime_prediction(uint32_t elapsed_ms, float current_ma)
+{
+  const RuntimePredictor::Prediction prediction = runtime_predictor_.update(elapsed_ms, current_ma, sample_.bus_voltage_v, remaining_capacity_mah_, // 平滑并预测
+                                                                            config_.battery_capacity_mah);
+  sample_.avg_current_ma = prediction.avg_current_ma; // 更新样本数据：平滑电流
+  sample_.time_to_empty_min = prediction.time_to_empty_min; // 更新样本数据：预计放空时间
+  sample_.time_to_full_min = prediction.time_to_full_min; // 更新样本数据：预计充满时间
+}
+
+void Ina226BatteryMonitor::build_rate_factor_table()
+{
+  const bool has_table = config_.rate_capacity_table != nullptr && config_.rate_capacity_table_len >= 1; // 是否提供了倍率-容量查表
+  const bool has_peukert = config_.peukert_exponent > 1.0f; // Peukert指数大于1才需要修正
+  const float max_current_ma = config_.max_current_amps * 1000.0f; // 表格覆盖的最大电流(mA)
+  is_rate_correction_enabled_ = (has_table || has_peukert) && max_current_ma > 0.0f && config_.battery_capacity_mah > 0.0f; // 判断是否启用修正
+  if (!is_rate_correction_enabled_) // 未启用修正
+  {
+    return; // 直接返回,查表时返回1
+  }
+
+  const float step_ma = max_current_ma / static_cast<float>(RATE_FACTOR_TABLE_SIZE - 1); // 相邻点的电流间隔
+  rate_factor_step_inv_ = 1.0f / step_ma; // 保存间隔倒数,查表时避免除法
+  for (size_t i = 0; i < RATE_FACTOR_TABLE_SIZE; i++) // 逐点计算修正系数
+  {
+    rate_factor_table_[i] = calc_rate_capacity_factor(step_ma * static_cast<float>(i)); // 计算该电流点的系数
+  }
+}
+
+float Ina226BatteryMonitor::calc_rate_capacity_factor(float discharge_current_ma) const
+{
+  if (config_.rate_capacity_table != nullptr && config_.rate_capacity_table_len >= 1) // 优先使用倍率-容量查表
+  {
+    const RateCapacityPoint *table = config_.rate_capacity_table; // 查表指针
+    const size_t table_len = config_.rate_capacity_table_len; // 查表长度
+    const float c_rate = discharge_current_ma / config_.battery_capacity_mah; // 当前放电倍率(C)
+    float capacity_percent = table[table_len - 1].capacity_percent; // 默认取最高倍率点
+    if (c_rate <= table[0].c_rate) // 低于最低倍率点
+    {
+      capacity_percent = table[0].capacity_percent; // 取最低倍率点
+    }
+    else
+    {
+      for (size_t i = 0; i + 1 < table_len; i++) // 遍历表格区间
+      {
+        if (c_rate <= table[i + 1].c_rate) // 找到所在区间
+        {
+          const float span = table[i + 1].c_rate - table[i].c_rate; // 区间宽度
+          const float ratio = span > 0.0f ? (c_rate - table[i].c_rate) / span : 0.0f; // 区间内位置
+          capacity_percent = table[i].capacity_percent + ratio * (table[i + 1].capacity_percent - table[i].capacity_percent); // 线性插值
+          break; // 结束查找
+        }
+      }
+    }
+    return capacity_percent > 0.0f ? 100.0f / capacity_percent : 1.0f; // 有效容量越小,等效消耗系数越大
+  }
+
+  const float rated_current_ma = config_.peukert_rated_current_ma > 0.0f ? config_.peukert_rated_current_ma : config_.battery_capacity_mah / 20.0f; // 额定电流,默认C/20
+  if (discharge_current_ma <= rated_current_ma || rated_current_ma <= 0.0f) // 低于额定电流时不放大容量,避免小电流下计数偏乐观
+  {
+    return 1.0f; // 不修正
+  }
+  return powf(discharge_current_ma / rated_current_ma, config_.peukert_exponent - 1.0f); // Peukert修正：(I/I_rated)^(k-1)
+}
+
+float Ina226BatteryMonitor::get_rate_capacity_factor(float discharge_current_ma) const
+{
+  if (!is_rate_correction_enabled_) // 未启用修正
+  {
+    return 1.0f; // 不修正
+  }
+
+  const float position = discharge_current_ma * rate_factor_step_inv_; // 电流在表中的位置
+  if (position >= static_cast<float>(RATE_FACTOR_TABLE_SIZE - 1)) // 超出表格范围
+  {
+    return rate_factor_table_[RATE_FACTOR_TABLE_SIZE - 1]; // 取最后一个点
+  }
+
+  const size_t index = static_cast<size_t>(position); // 区间下标
+  const float fraction = position - static_cast<float>(index); // 区间内位置
+  return rate_factor_table_[index] + fraction * (rate_factor_table_[index + 1] - rate_factor_table_[index]); // 线性插值
+}
+
+float Ina226BatteryMonitor::calc_charge_efficiency_factor() const
+{
+  const ChargeEfficiencyPoint *table = config_.charge_efficiency_table; // SOC-效率系数查表
+  const size_t table_len = config_.charge_efficiency_table_len; // 查表长度
+  if (table == nullptr || table_len == 0) // 未提供查表
+  {
+    return 1.0f; // 不修正
+  }
+
+  float factor = table[table_len - 1].factor; // 默认取最高SOC点
+  if (soc_percent_ <= table[0].soc_percent) // 低于最低SOC点
+  {
+    factor = table[0].factor; // 取最低SOC点
+  }
+  else
+  {
+    for (size_t i = 0; i + 1 < table_len; i++) // 遍历表格区间
+    {
+      if (soc_percent_ <= table[i + 1].soc_percent) // 找到所在区间
+      {
+        const float span = table[i + 1].soc_percent - table[i].soc_percent; // 区间宽度
+        const float ratio = span > 0.0f ? (soc_percent_ - table[i].soc_percent) / span : 0.0f; // 区间内位置
+        factor = table[i].factor + ratio * (table[i + 1].factor - table[i].factor); // 线性插值
+        break; // 结束查找
+      }
+    }
+  }
+  return factor; // 返回SOC系数
+}
+
+void Ina226BatteryMonitor::learn_charge_efficiency_at_full_charge()
+{
+  if (!config_.enable_efficiency_learning) // 未启用学习
+  {
+    return; // 直接返回
+  }
+
+  const double min_cycle_mah = config_.battery_capacity_mah * config_.efficiency_learning_min_cycle_percent / 100.0; // 有效循环的最小放电量
+  if (has_full_charge_reference_ && cycle_charge_in_mah_ > 0.0 && cycle_discharge_out_mah_ >= min_cycle_mah) // 完成了一次足够深的满充到满充循环
+  {
+    float estimate = static_cast<float>(cycle_discharge_out_mah_ / cycle_charge_in_mah_); // 满充到满充：放出 = 充入 * 效率
+    if (estimate > 1.0f) // 限制上限
+      estimate = 1.0f; // 效率不超过100%
+    if (estimate < 0.5f) // 限制下限,防止异常循环污染学习值
+      estimate = 0.5f; // 效率不低于50%
+
+    if (isnan(learned_charge_efficiency_)) // 首次学习
+    {
+      learned_charge_efficiency_ = estimate; // 直接采用估计值
+    }
+    else
+    {
+      learned_charge_efficiency_ += 0.3f * (estimate - learned_charge_efficiency_); // 与历史值加权平均,抑制单次循环误差
+    }
+    logf("Charge efficiency learned: cycle=%s, now=%s\n", FixedPointText(estimate, 4).c_str(), FixedPointText(learned_charge_efficiency_, 4).c_str()); // 打印日志：学习结果
+    record_event(BatteryEventType::EFFICIENCY_LEARNED, static_cast<uint32_t>(learned_charge_efficiency_ * 10000.0f + 0.5f)); // 记录事件：效率学习
+  }
+
+  has_full_charge_reference_ = true; // 本次满充作为下一个循环的起点
+  cycle_charge_in_mah_ = 0.0; // 清零本循环充入电量
+  cycle_discharge_out_mah_ = 0.0; // 清零本循环放出电量
+}
+
+void Ina226BatteryMonitor::handle_set_time_command(Stream *serial)
+{
+  char buffer[24]; // 命令参数缓冲
+  const size_t length = serial->readBytesUntil('\n', buffer, sizeof(buffer) - 1); // 读取到换行为止(带超时)
+  buffer[length] = '\0'; // 字符串结束符
+
+  char *end = nullptr; // 解析结束位置
+  const unsigned long long epoch_s = strtoull(buffer, &end, 10); // 解析Unix时间(秒)
+  if (end == buffer || epoch_s == 0) // 没有有效数字
+  {
+    logf("Usage: T<unix seconds>\n"); // 打印日志：命令格式
+    return; // 直接返回
+  }
+  set_epoch_ms(static_cast<uint64_t>(epoch_s) * 1000ULL); // 设置绝对时间
+}
+
+void Ina226BatteryMonitor::record_event(BatteryEventType type, uint32_t detail)
+{
+  if (event_log_ == nullptr) // 未挂接事件日志
+  {
+    return; // 直接返回
+  }
+
+  DeferredEvent event{}; // 以当前样本数据生成事件
+  event.type = type; // 事件类型
+  event.timestamp_ms = clock_.to_record_timestamp_ms(clock_.extend(millis())); // 优先使用绝对时间
+  event.has_epoch = clock_.has_epoch(); // 时间戳是否为绝对时间
+  event.soc_percent = soc_percent_; // SOC
+  event.bus_voltage_v = sample_.bus_voltage_v; // 电压
+  event.current_ma = sample_.current_ma; // 电流
+  event.detail = detail; // 附加信息
+  if (!is_output_deferred_) // 未持有总线
+  {
+    append_event(event); // 直接写入
+    return; // 返回
+  }
+  if (deferred_event_count_ < MAX_DEFERRED_EVENTS) // 队列未满
+  {
+    deferred_events_[deferred_event_count_++] = event; // 暂存,保留发生时的时间与样本
+  }
+  else
+  {
+    deferred_event_drop_count_++; // 计入丢弃数
+  }
+}
+
+void Ina226BatteryMonitor::append_event(const DeferredEvent &event)
+{
+  if (!event_log_->append(event.type, event.timestamp_ms, event.has_epoch, event.soc_percent, event.bus_voltage_v, event.current_ma, event.detail)) // 写入事件记录
+  {
+    logf("Event log append failed\n"); // 打印日志：事件写入失败
+  }
+}
+
+void Ina226BatteryMonitor::flush_deferred_output()
+{
+  for (uint8_t i = 0; i < deferred_log_count_; i++) // 按发生顺序输出日志
+  {
+    logger_->print(deferred_logs_[i]); // 暂存时已确认日志对象有效
+  }
+  if (deferred_log_drop_count_ > 0) // 有日志被丢弃
+  {
+    logf("%u deferred log lines dropped\n", static_cast<unsigned int>(deferred_log_drop_count_)); // 打印日志：丢弃数
+  }
+  deferred_log_count_ = 0; // 清空日志队列
+  deferred_log_drop_count_ = 0; // 清零丢弃数
+
+  for (uint8_t i = 0; i < deferred_event_count_; i++) // 按发生顺序写入事件
+  {
+    append_event(deferred_events_[i]); // 写入事件日志分区
+  }
+  if (deferred_event_drop_count_ > 0) // 有事件被丢弃
+  {
+    logf("%u deferred events dropped\n", static_cast<unsigned int>(deferred_event_drop_count_)); // 打印日志：丢弃数
+  }
+  deferred_event_count_ = 0; // 清空事件队列
+  deferred_event_drop_count_ = 0; // 清零丢弃数
+}
+
+void Ina226BatteryMonitor::logf(const char *format, ...) const 
+{
+  if (logger_ == nullptr) // 如果日志对象未设置
+  {
+    return; // 直接返回
+  }
+
+  if (is_output_deferred_ && deferred_log_count_ >= MAX_DEFERRED_LOGS) // 持有总线且队列已满
+  {
+    deferred_log_drop_count_++; // 计入丢弃数
+    return; // 直接返回
+  }
+
+  char buffer[LOG_LINE_SIZE]; // 定义缓冲区
+  char *line = is_output_deferred_ ? deferred_logs_[deferred_log_count_] : buffer; // 持有总线时直接格式化到队列
+  va_list args; // 定义可变参数列表
+  va_start(args, format); // 初始化可变参数
+  vsnprintf(line, LOG_LINE_SIZE, format, args); // 格式化字符串到缓冲区
+  va_end(args); // 结束可变参数处理
+  if (is_output_deferred_) // 持有总线
+  {
+    deferred_log_count_++; // 暂存,释放总线后输出
+    return; // 返回
+  }
+  logger_->print(line); // 输出日志
 }
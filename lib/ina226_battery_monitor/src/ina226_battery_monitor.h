@@ -2,15 +2,45 @@
 
 #include <Arduino.h> // 包含Arduino核心库
 #include <INA226.h> // 包含INA226驱动库
+#include <freertos/FreeRTOS.h> // 包含FreeRTOS基础定义
+#include <freertos/task.h> // 包含任务接口
+
+#include "cell_voltage_monitor.h" // 包含单节电压监视器
+#include "monotonic_clock.h" // 包含64位单调时间基准
+#include "runtime_predictor.h" // 包含剩余时间预测器
+#include "temperature_source.h" // 包含温度源接口
 
 #include <math.h> // 包含数学库
 
+class BatteryEventLog; // 电池事件日志(前置声明)
+class I2cBusArbiter; // I2C总线仲裁器(前置声明)
+enum class BatteryEventType : uint8_t; // 电池事件类型(前置声明)
+
 /**
  * @brief INA226 电池监视器类
  */
 class Ina226BatteryMonitor
 {
 public:
+  static constexpr uint8_t PROTECTION_FAULT_OVER_CURRENT = 0x01; // 保护故障位：过流
+  static constexpr uint8_t PROTECTION_FAULT_UNDER_VOLTAGE = 0x02; // 保护故障位：欠压
+  static constexpr uint8_t PROTECTION_FAULT_OVER_TEMPERATURE = 0x04; // 保护故障位：过温
+
+  /**
+   * @brief 内置电池化学体系预设
+   */
+  enum class BatteryPreset : uint8_t
+  {
+    CUSTOM, // 不使用预设,全部参数手动配置
+    LI_ION_1S, // 锂离子1串
+    LI_ION_2S, // 锂离子2串
+    LI_ION_3S, // 锂离子3串
+    LI_ION_4S, // 锂离子4串
+    LIFEPO4_1S, // 磷酸铁锂1串
+    LIFEPO4_4S, // 磷酸铁锂4串
+    LEAD_ACID_12V, // 铅酸12V(6格)
+  };
+
   /**
    * @brief 电池SOC电压对照点结构体
    */
@@ -20,6 +50,33 @@ public:
     float soc_percent; // 对应的SOC百分比(0-100)
   };
 
+  /**
+   * @brief 放电倍率-有效容量对照点结构体
+   */
+  struct RateCapacityPoint
+  {
+    float c_rate; // 放电倍率(C),即放电电流/额定容量
+    float capacity_percent; // 该倍率下的有效容量占额定容量的百分比(%)
+  };
+
+  /**
+   * @brief SOC-充电效率系数对照点结构体
+   */
+  struct ChargeEfficiencyPoint
+  {
+    float soc_percent; // SOC百分比(0-100)
+    float factor; // 该SOC下相对基础充电效率的系数(0-1)
+  };
+
+  /**
+   * @brief 温度-修正系数对照点结构体
+   */
+  struct TemperatureFactorPoint
+  {
+    float temperature_c; // 温度(°C)
+    float factor; // 该温度下的修正系数
+  };
+
   /**
    * @brief 配置结构体
    */
@@ -35,22 +92,95 @@ public:
     float shunt_resistor_ohm = 0.02f; // 采样电阻阻值(Ohm)
     float max_current_amps = 4.0f; // 预期的最大电流(A)
     int current_polarity = 1; // 电流极性修正: 1 或 -1
+    bool enable_auto_range = false; // 是否按电流大小在低量程与满量程校准之间自动切换
+    float low_range_max_current_amps = 0.2f; // 低量程的最大电流(A),电流LSB随之变细
+    float auto_range_up_percent = 90.0f; // 低量程下电流超过其最大电流的此比例(%)时立即切换到满量程
+    float auto_range_down_percent = 70.0f; // 满量程下电流持续低于低量程最大电流的此比例(%)时切换到低量程
+    uint32_t auto_range_down_hold_ms = 1000; // 切换到低量程前电流需持续低于阈值的时长(ms)
+
+    bool enable_dual_shunt = false; // 是否启用双分流:第二片INA226接大阻值分流电阻测量小电流,与本通道合并为一路电流
+    uint8_t low_range_i2c_address = 0x41; // 低量程INA226的I2C地址(与本通道共用wire)
+    float low_range_shunt_resistor_ohm = 1.0f; // 低量程分流电阻阻值(Ohm)
+    float low_range_shunt_max_current_amps = 0.05f; // 低量程最大电流(A)
+    float dual_shunt_crossfade_start_percent = 60.0f; // 电流超过低量程最大电流的此比例(%)时开始向高量程过渡
+    float dual_shunt_crossfade_end_percent = 90.0f; // 电流超过低量程最大电流的此比例(%)时完全使用高量程
     float current_deadzone_ma = 1.0f; // 电流死区(mA),小于此值视为0
     uint8_t average = INA226_16_SAMPLES; // INA226平均采样点数
+    bool enable_raw_sample_path = false; // 是否使用原始寄存器模式:逐次采样只做整数积分与保护,浮点处理按折算周期进行
+    uint32_t raw_fold_interval_ms = 1000; // 原始寄存器模式下整数累加器折算到剩余容量的周期(ms)
+    uint8_t bus_voltage_read_divider = 1; // 每N次更新读取一次总线电压寄存器,其余沿用上次值(电流寄存器每次都读);0会被修正为1,欠压保护与功率依赖电压
+    uint8_t shunt_voltage_read_divider = 1; // 每N次更新读取一次分流电压寄存器,0表示从不读取;未读取时由电流*分流电阻推算
+    uint8_t power_read_divider = 1; // 每N次更新读取一次功率寄存器,0表示从不读取;未读取时由电压*电流推算
 
+    BatteryPreset battery_preset = BatteryPreset::CUSTOM; // 电池化学体系预设,非CUSTOM时覆盖SOC查表、满充判定、效率及静置校准参数
     const SocPoint *soc_table = nullptr; // 自定义SOC查表数组指针
     size_t soc_table_len = 0; // 自定义SOC查表数组长度
+    uint8_t soc_table_cell_count = 1; // SOC查表对应的串联节数,查表前电压先除以此值(整包查表为1)
 
     const char *nvs_namespace = "bat"; // NVS命名空间
     const char *nvs_key_state = "state"; // NVS键名,用于存储状态
     uint32_t save_interval_ms = 10UL * 60UL * 1000UL; // 自动保存到NVS的时间间隔(ms)
+    bool enable_background_nvs_save = true; // NVS提交交给低优先级写入任务,update()只投递24字节状态;任务创建失败时在update()中直接写入
+    uint32_t sample_gap_threshold_ms = 0; // update()间隔超过此值(ms)计为一次采样缺口,0表示只统计最大间隔
     double min_save_delta_mah = 1.0; // 触发NVS保存的最小容量变化(mAh)
 
-    uint32_t startup_voltage_samples = 5; // 启动时的电压采样次数,用于初始估算
-    uint32_t startup_voltage_sample_delay_ms = 50; // 启动时每次电压采样的间隔(ms)
+    bool enable_warm_restart = false; // 软件复位/看门狗复位/异常复位后是否从RTC内存恢复完整状态,跳过启动电压采样和NVS读取
+
+    bool enable_startup_hw_average = true; // 启动电压是否使用一次触发转换+INA226硬件平均,失败时退回软件循环
+    uint8_t startup_hw_average = INA226_1024_SAMPLES; // 启动电压硬件平均点数
+    uint8_t startup_hw_conversion_time = INA226_140_us; // 启动电压单次转换时间,与平均点数共同决定启动耗时(1024*140us约143ms)
+    uint32_t startup_voltage_samples = 5; // 启动时的电压采样次数,用于初始估算(软件循环)
+    uint32_t startup_voltage_sample_delay_ms = 50; // 启动时每次电压采样的间隔(ms)(软件循环)
 
     float full_charge_voltage_v = 12.5f; // 满充判定电压(V)
     float full_charge_current_ma = 50.0f; // 满充判定电流(mA),小于此值且电压满足视为满充
+    float full_charge_rearm_percent = 2.0f; // 满充后剩余容量需下降超过满容量的此百分比才会再次判定满充,抑制阈值附近的噪声
+
+    float runtime_filter_time_constant_s = 60.0f; // 剩余时间预测的电流/功率平滑时间常数(s)
+    bool enable_constant_power_runtime = false; // 是否按恒功率负载预测剩余时间(使用功率而非电流)
+
+    float peukert_exponent = 1.0f; // Peukert指数,1.0表示不做放电倍率修正
+    float peukert_rated_current_ma = 0.0f; // 额定容量对应的放电电流(mA),0表示使用C/20
+    const RateCapacityPoint *rate_capacity_table = nullptr; // 放电倍率-有效容量查表(按倍率升序),优先于Peukert指数
+    size_t rate_capacity_table_len = 0; // 放电倍率-有效容量查表长度
+
+    float charge_efficiency = 1.0f; // 基础充电库仑效率(0-1),充入电量先乘以效率再累加
+    const ChargeEfficiencyPoint *charge_efficiency_table = nullptr; // SOC-充电效率系数查表(按SOC升序),可为空
+    size_t charge_efficiency_table_len = 0; // SOC-充电效率系数查表长度
+    bool enable_efficiency_learning = false; // 是否根据满充到满充的循环学习充电效率
+    float efficiency_learning_min_cycle_percent = 20.0f; // 参与学习的循环最小放电深度(%)
+
+    uint32_t rest_recalibration_ms = 0; // 静置多久后按开路电压校准SOC(ms),0表示不校准
+    float rest_current_ma = 5.0f; // 判定静置的电流上限(mA)
+    float ocv_plateau_min_soc_percent = 0.0f; // 开路电压平台区下限(%),平台区内电压无法分辨SOC,不做校准
+    float ocv_plateau_max_soc_percent = 0.0f; // 开路电压平台区上限(%),上下限相等表示没有平台区
+    float weakest_cell_soc_time_constant_s = 120.0f; // 静置电流下运行SOC高于最弱单节SOC时按此时间常数(s)向其收敛,0表示不修正
+
+    float self_discharge_percent_per_month = 0.0f; // 关机期间的自放电率(%/月),0表示不补偿
+    uint32_t ocv_relaxation_time_s = 6UL * 3600UL; // 关机达到此时长(秒)时启动电压完全弛豫,开路电压置信度不再因时长打折
+    float ocv_blend_weight = 0.5f; // 启动时开路电压置信度为1时,向开路电压估算值靠拢的权重(0-1)
+    float soc_plausibility_threshold_percent = 15.0f; // NVS与开路电压SOC相差超过此值(%)时认为NVS不可信(换电池/关机时外部充电)
+    float ocv_override_min_confidence = 0.5f; // NVS不可信时直接采用开路电压所需的最低置信度(0-1)
+
+    uint32_t temperature_interval_ms = 5000; // 温度测量周期(ms),低于电流采样频率
+    const TemperatureFactorPoint *capacity_temp_table = nullptr; // 温度-有效容量系数查表(按温度升序),可为空,系数需大于0
+    size_t capacity_temp_table_len = 0; // 温度-有效容量系数查表长度
+    const TemperatureFactorPoint *charge_efficiency_temp_table = nullptr; // 温度-充电效率系数查表(按温度升序),可为空,系数需大于0
+    size_t charge_efficiency_temp_table_len = 0; // 温度-充电效率系数查表长度
+
+    int protection_gpio = -1; // 负载开关(MOSFET)控制引脚,-1表示不驱动GPIO
+    bool is_load_on_level_high = true; // 负载接通时控制引脚输出高电平
+    float over_current_ma = 0.0f; // 过流保护阈值(mA,绝对值),0表示不检测
+    uint32_t over_current_delay_ms = 0; // 过流持续多久后断开(ms)
+    bool is_over_current_latched = true; // 过流保护是否锁存,锁存后需调用clear_protection_faults()恢复
+    float under_voltage_v = 0.0f; // 欠压保护阈值(V),0表示不检测
+    float under_voltage_hysteresis_v = 0.2f; // 欠压恢复回差(V)
+    uint32_t under_voltage_delay_ms = 2000; // 欠压持续多久后断开(ms)
+    float over_temperature_c = NAN; // 过温保护阈值(°C),NAN表示不检测
+    float over_temperature_hysteresis_c = 5.0f; // 过温恢复回差(°C)
+    uint32_t over_temperature_delay_ms = 5000; // 过温持续多久后断开(ms)
+    uint32_t protection_release_delay_ms = 5000; // 故障解除后延时恢复负载(ms)
+    int alert_gpio = -1; // INA226 ALERT引脚,启用后过流由硬件比较器触发中断立即断开负载,-1表示不使用
   };
 
   /**
@@ -58,6 +188,7 @@ public:
    */
   struct Sample
   {
+    uint64_t timestamp_ms = 0; // 采样时间戳(ms),已知绝对时间时为Unix时间,否则为本次启动的单调时间
     float bus_voltage_v = NAN; // 总线电压(V)
     float shunt_voltage_mv = NAN; // 分流电阻电压(mV)
     float current_ma = NAN; // 电流(mA)
@@ -65,6 +196,28 @@ public:
     float power2_mw = NAN; // 计算功率 P=U*I (mW)
     double remaining_capacity_mah = NAN; // 剩余容量(mAh)
     float soc_percent = NAN; // 剩余电量百分比(%)
+    float avg_current_ma = NAN; // 平滑后的电流(mA),放电为正
+    float time_to_empty_min = NAN; // 预计放空时间(min),非放电状态为NAN
+    float time_to_full_min = NAN; // 预计充满时间(min),非充电状态为NAN
+    float min_cell_voltage_v = NAN; // 最低单节电压(V),未接单节监视器时为NAN
+    float max_cell_voltage_v = NAN; // 最高单节电压(V)
+    float cell_imbalance_mv = NAN; // 单节压差(mV)
+    float weakest_cell_soc_percent = NAN; // 最弱单节按电压估算的SOC(%)
+    float temperature_c = NAN; // 电池温度(°C),未接温度源时为NAN
+    uint8_t protection_faults = 0; // 当前生效的保护故障位(PROTECTION_FAULT_*)
+    float low_range_weight = NAN; // 双分流模式下低量程通道的权重(0-1),低量程饱和时为0,未启用时为NAN
+  };
+
+  /**
+   * @brief 采样间隔诊断统计,用于评估NVS写入等阻塞操作造成的采样缺口
+   */
+  struct SampleGapStats
+  {
+    uint32_t max_gap_ms = 0; // 相邻两次update()的最大间隔(ms)
+    uint32_t gap_count = 0; // 间隔超过sample_gap_threshold_ms的次数
+    uint32_t last_nvs_save_us = 0; // 最近一次完成的NVS写入耗时(us),后台写入时在写入任务中计时
+    uint32_t max_nvs_save_us = 0; // NVS写入最大耗时(us),后台写入时采样只在其中的Flash操作期间停顿
+    uint32_t bus_lock_timeout_count = 0; // 获取共享I2C总线超时而跳过采样的次数
   };
 
   /**
@@ -79,6 +232,35 @@ public:
    */
   void set_logger(Print *logger);
 
+  /**
+   * @brief 挂接单节电压监视器
+   * @param cell_monitor 单节电压监视器指针,nullptr表示不使用
+   * @note 需要在begin()之前调用,begin()会负责初始化它;挂接后按电压估算SOC时使用最弱单节,
+   *       静置电流下运行SOC也不会长时间高于最弱单节SOC
+   */
+  void set_cell_voltage_monitor(CellVoltageMonitor *cell_monitor);
+
+  /**
+   * @brief 挂接温度源
+   * @param temperature_source 温度源指针,nullptr表示不使用
+   * @note 需要在begin()之前调用,begin()会负责初始化它
+   */
+  void set_temperature_source(TemperatureSource *temperature_source);
+
+  /**
+   * @brief 挂接事件日志
+   * @param event_log 事件日志指针,nullptr表示不记录;日志需由调用者先执行begin()
+   */
+  void set_event_log(BatteryEventLog *event_log);
+
+  /**
+   * @brief 挂接共享I2C总线仲裁器
+   * @param bus_arbiter 仲裁器指针,nullptr表示独占总线;仲裁器需由调用者先执行begin()
+   * @note 需要在begin()之前调用;挂接后采样期间以高优先级占用总线,
+   *       同一总线上的其他设备也必须经由该仲裁器访问
+   */
+  void set_bus_arbiter(I2cBusArbiter *bus_arbiter);
+
   /**
    * @brief 初始化电池监视器
    * @return true 初始化成功, false 初始化失败
@@ -88,7 +270,7 @@ public:
   /**
    * @brief 更新电池状态
    * @param now_ms 当前系统时间戳(ms)
-   * @param serial 可选的调试串口,用于接收调试指令('c'清除NVS, 'r'重置状态)
+   * @param serial 可选的调试串口,用于接收调试指令('c'清除NVS, 'r'重置状态, 'd'导出事件日志, 't<Unix秒>'设置时间)
    */
   void update(uint32_t now_ms, Stream *serial = nullptr);
 
@@ -101,12 +283,69 @@ public:
   /**
    * @brief 获取最新的采样数据
    * @return Sample结构体的常量引用
+   * @note 原始寄存器模式下,电压/电流/功率字段在此按需由寄存器值换算
    */
   const Sample &sample() const;
 
+  /**
+   * @brief 获取当前使用的基础充电效率
+   * @return 已学习到的效率,未学习时返回配置值
+   */
+  float get_charge_efficiency() const;
+
+  /**
+   * @brief 设置当前的绝对时间(来自RTC/NTP)
+   * @param epoch_ms 当前Unix时间(ms)
+   */
+  void set_epoch_ms(uint64_t epoch_ms);
+
+  /**
+   * @brief 获取采样间隔诊断统计
+   * @return 统计结构体的常量引用
+   */
+  const SampleGapStats &get_sample_gap_stats() const;
+
+  /**
+   * @brief 清零采样间隔诊断统计
+   */
+  void reset_sample_gap_stats();
+
+  /**
+   * @brief 获取监视器使用的时间基准
+   * @return 单调时间基准的常量引用
+   */
+  const MonotonicClock &get_clock() const;
+
+  /**
+   * @brief 获取当前生效的保护故障位
+   * @return PROTECTION_FAULT_* 的按位组合,0表示无故障
+   */
+  uint8_t get_protection_faults() const;
+
+  /**
+   * @brief 负载开关当前是否接通
+   * @return true 接通, false 已被保护断开
+   */
+  bool is_load_enabled() const;
+
+  /**
+   * @brief 清除锁存的保护故障
+   * @note 故障条件仍然存在时,会在下一次采样按延时重新触发
+   */
+  void clear_protection_faults();
+
+  /**
+   * @brief 计算CRC32校验和(小端序)
+   * @param data 数据指针
+   * @param length 数据长度
+   * @return 计算出的CRC32值
+   */
+  static uint32_t calc_crc32_le(const uint8_t *data, size_t length);
+
   /**
    * @brief 根据电压重置电池状态(SOC和容量)
    * @param voltage_v 当前电池电压(V)
+   * @note 挂接了单节电压监视器且扫描有效时,使用最弱单节电压代替整包电压
    */
   void reset_state_from_voltage(float voltage_v);
 
@@ -123,19 +362,64 @@ private:
   {
     uint32_t magic; // 魔数,用于校验数据有效性
     uint16_t version; // 版本号
-    uint16_t reserved; // 保留字段
+    uint16_t learned_efficiency_x10000; // 学习到的充电效率 * 10000,0表示未学习
     uint32_t capacity_mah_x1; // 电池总容量
     uint32_t remaining_mah_x100; // 剩余容量 * 100
+    uint32_t saved_epoch_s; // 保存时的Unix时间(秒),0表示未知(版本2新增)
     uint32_t crc32; // CRC32校验和
   };
 
   /**
-   * @brief 计算CRC32校验和(小端序)
-   * @param data 数据指针
-   * @param length 数据长度
-   * @return 计算出的CRC32值
+   * @brief 持有总线期间暂存的事件,保留发生时的时间与样本
    */
-  static uint32_t calc_crc32_le(const uint8_t *data, size_t length);
+  struct DeferredEvent
+  {
+    BatteryEventType type; // 事件类型
+    uint64_t timestamp_ms; // 时间戳(ms)
+    bool has_epoch; // 时间戳是否为绝对时间
+    float soc_percent; // SOC(%)
+    float bus_voltage_v; // 总线电压(V)
+    float current_ma; // 电流(mA)
+    uint32_t detail; // 附加信息
+  };
+
+  /**
+   * @brief 保留在RTC内存中的热重启快照,每次更新后写入
+   * @note 字段按对齐排列,无需packed;容量与分流电阻作为配置指纹,不一致时不恢复
+   */
+  struct RetainedMonitorState
+  {
+    uint32_t magic; // 魔数,冷启动时RTC内存为随机值
+    uint16_t version; // 版本号
+    uint16_t size; // 结构体大小
+    float capacity_mah; // 配置指纹：电池总容量
+    float shunt_resistor_ohm; // 配置指纹：分流电阻
+    uint64_t monotonic_ms; // 最后一次积分的单调时间
+    double remaining_capacity_mah; // 剩余容量
+    double last_saved_remaining_capacity_mah; // 上次保存到NVS的容量
+    double cycle_charge_in_mah; // 本循环充入电量
+    double cycle_discharge_out_mah; // 本循环放出电量
+    float learned_charge_efficiency; // 学习到的充电效率
+    float filtered_current_ma; // 平滑电流
+    float filtered_power_mw; // 平滑功率
+    uint8_t protection_faults; // 生效的保护故障位
+    uint8_t flags; // 状态标志位,见RETAINED_FLAG_*
+    uint16_t reserved; // 保留
+    uint32_t crc32; // CRC32校验和
+  };
+
+  static constexpr uint8_t RETAINED_FLAG_FULL_CHARGE_REFERENCE = 0x01; // 已经历过一次满充
+  static constexpr uint8_t RETAINED_FLAG_FULL_CHARGE_LATCHED = 0x02; // 满充事件已记录
+  static constexpr uint8_t RETAINED_FLAG_DEPLETED_LATCHED = 0x04; // 耗尽事件已记录
+
+  /**
+   * @brief 单项保护的延时计时器
+   */
+  struct ProtectionTimer
+  {
+    bool is_pending = false; // 条件是否正在计时
+    uint32_t since_ms = 0; // 开始计时的时间戳
+  };
 
   /**
    * @brief 检查NVS是否启用
@@ -146,9 +430,12 @@ private:
   /**
    * @brief 从NVS加载剩余容量
    * @param out_remaining_capacity_mah 输出参数,加载到的剩余容量
+   * @param out_learned_charge_efficiency 输出参数,学习到的充电效率,未学习时为NAN
+   * @param out_saved_epoch_s 输出参数,保存时的Unix时间(秒),未知时为0
    * @return true 加载成功, false 加载失败
+   * @note 兼容读取不含保存时间的版本1数据
    */
-  bool load_remaining_capacity_from_nvs(double &out_remaining_capacity_mah) const;
+  bool load_remaining_capacity_from_nvs(double &out_remaining_capacity_mah, float &out_learned_charge_efficiency, uint32_t &out_saved_epoch_s) const;
 
   /**
    * @brief 保存剩余容量到NVS
@@ -157,6 +444,21 @@ private:
    */
   bool save_remaining_capacity_to_nvs(double remaining_capacity_mah) const;
 
+  /**
+   * @brief 生成待保存的持久化状态
+   * @param remaining_capacity_mah 当前剩余容量
+   * @return 带CRC的持久化状态
+   */
+  PersistedBatteryState build_persisted_state(double remaining_capacity_mah) const;
+
+  /**
+   * @brief 将持久化状态写入NVS
+   * @param state 持久化状态
+   * @return true 写入成功, false 写入失败
+   * @note 不输出日志,可在写入任务中调用
+   */
+  bool write_persisted_state(const PersistedBatteryState &state) const;
+
   /**
    * @brief 根据电压估算SOC
    * @param voltage_v 电池电压(V)
@@ -164,6 +466,136 @@ private:
    */
   float get_soc_from_voltage(float voltage_v) const;
 
+  /**
+   * @brief 以一次触发的总线电压转换和高倍硬件平均测量启动电压
+   * @param out_voltage_v 输出参数,测得的总线电压(V)
+   * @return true 转换完成, false 超时或通信失败
+   * @note 结束后恢复运行时的平均点数、转换时间和连续转换模式
+   */
+  bool measure_startup_voltage_hw_average(float &out_voltage_v);
+
+  /**
+   * @brief 按电压估算SOC,有单节数据时以最弱单节为准
+   * @param pack_voltage_v 整包电压(V)
+   * @return 估算的SOC百分比(0-100)
+   */
+  float estimate_soc_from_voltage(float pack_voltage_v) const;
+
+  /**
+   * @brief 调度单节电压扫描并更新样本中的单节统计
+   * @param now_ms 当前时间戳(ms)
+   */
+  void update_cell_voltages(uint32_t now_ms);
+
+  /**
+   * @brief 按测量周期调度温度测量并更新温度相关系数
+   * @param now_ms 当前时间戳(ms)
+   */
+  void update_temperature(uint32_t now_ms);
+
+  /**
+   * @brief 在温度-系数查表中线性插值
+   * @param table 查表指针(按温度升序)
+   * @param table_len 查表长度
+   * @param temperature_c 温度(°C)
+   * @return 插值得到的系数,查表为空时返回1
+   */
+  static float interpolate_temperature_factor(const TemperatureFactorPoint *table, size_t table_len, float temperature_c);
+
+  /**
+   * @brief 初始化保护引脚与INA226硬件告警
+   */
+  void begin_protection();
+
+  /**
+   * @brief 在采样路径中评估保护条件并驱动负载开关
+   * @param now_ms 当前时间戳(ms)
+   * @param is_over_current 电流是否超过过流阈值
+   * @param is_under_voltage 电压是否低于欠压阈值
+   * @param is_under_voltage_released 电压是否高于欠压阈值加回差
+   * @note 比较由调用者完成,浮点路径与原始寄存器路径共用同一套计时与负载控制
+   */
+  void update_protection(uint32_t now_ms, bool is_over_current, bool is_under_voltage, bool is_under_voltage_released);
+
+  /**
+   * @brief 按当前电流LSB预计算原始寄存器模式使用的整数阈值
+   * @note 校准(电流LSB)改变后需要重新调用
+   */
+  void update_raw_thresholds();
+
+  /**
+   * @brief 原始寄存器模式的逐次采样:读取寄存器、整数积分并评估保护
+   * @param now_ms 当前时间戳(ms)
+   * @return true 到达折算周期,需要执行浮点处理, false 本次只做了整数处理
+   */
+  bool update_raw(uint32_t now_ms);
+
+  /**
+   * @brief 将整数电荷累加器折算为折算周期内的平均电流并清零
+   * @return 平均电流(mA),放电为正,已应用死区
+   */
+  float fold_raw_charge();
+
+  /**
+   * @brief 由最近一次的原始寄存器值换算样本中的电压/电流/功率字段
+   * @note 本周期未读取的分流电压与功率由电流推算
+   */
+  void refresh_sample_from_raw() const;
+
+  /**
+   * @brief 读取低量程通道并与高量程电流合并
+   * @param high_range_current_ma 本通道(高量程)电流(mA),已应用极性
+   * @return 合并后的电流(mA),已应用极性
+   * @note 低量程饱和时只使用高量程,过渡区内按电流大小线性交叉淡化
+   */
+  float merge_dual_shunt_current(float high_range_current_ma);
+
+  /**
+   * @brief 根据当前电流决定是否切换量程
+   * @param now_ms 当前时间戳(ms)
+   * @param abs_current_ma 当前电流绝对值(mA)
+   */
+  void update_auto_range(uint32_t now_ms, float abs_current_ma);
+
+  /**
+   * @brief 改写校准寄存器切换电流量程
+   * @param is_low_range true 切换到低量程, false 切换到满量程
+   * @note 先将整数累加器按旧LSB折算,切换后第一次采样改用分流电压推算电流
+   */
+  void switch_current_range(bool is_low_range);
+
+  /**
+   * @brief 判断某个寄存器在本次更新中是否需要读取
+   * @param divider 读取分频,0表示从不读取
+   * @return true 需要读取, false 跳过
+   */
+  bool is_register_read_due(uint8_t divider) const;
+
+  /**
+   * @brief 评估单项保护条件的触发与解除
+   * @param timer 该项保护的触发计时器
+   * @param fault 故障位
+   * @param is_tripping 是否满足触发条件
+   * @param is_releasing 是否满足解除条件(含回差)
+   * @param trip_delay_ms 触发延时(ms)
+   * @param is_latched 是否锁存
+   * @param now_ms 当前时间戳(ms)
+   */
+  void evaluate_protection(ProtectionTimer &timer, uint8_t fault, bool is_tripping, bool is_releasing, uint32_t trip_delay_ms, bool is_latched, uint32_t now_ms);
+
+  /**
+   * @brief 驱动负载开关
+   * @param is_enabled true 接通负载, false 断开负载
+   */
+  void set_load_enabled(bool is_enabled);
+
+  /**
+   * @brief INA226 ALERT引脚中断服务函数,立即断开负载
+   * @param arg 监视器实例指针
+   * @note 驻留IRAM并直接写GPIO寄存器,Flash擦写(NVS提交)期间也能响应
+   */
+  static void IRAM_ATTR on_alert_interrupt(void *arg);
+
   /**
    * @brief 尝试保存到NVS(根据策略判断是否需要保存)
    * @param now_ms 当前时间戳(ms)
@@ -171,26 +603,279 @@ private:
    */
   void maybe_save_to_nvs(uint32_t now_ms, bool force);
 
+  /**
+   * @brief 创建后台NVS写入任务
+   * @return true 创建成功, false 创建失败(之后在update()中直接写入)
+   */
+  bool start_nvs_writer();
+
+  /**
+   * @brief 后台NVS写入任务,等待投递的状态并写入
+   * @param arg 监视器实例指针
+   */
+  static void nvs_writer_task(void *arg);
+
+  /**
+   * @brief 取回后台写入任务完成的保存结果并处理
+   */
+  void collect_nvs_save_result();
+
+  /**
+   * @brief 处理一次NVS保存的结果:更新耗时统计、上次保存值、日志与事件
+   * @param is_saved 是否写入成功
+   * @param save_us 写入耗时(us)
+   * @param saved_remaining_capacity_mah 写入的剩余容量(mAh)
+   */
+  void finish_nvs_save(bool is_saved, uint32_t save_us, double saved_remaining_capacity_mah);
+
+  /**
+   * @brief 从RTC内存快照恢复积分状态、时间基准与计数
+   * @return true 快照有效且与当前配置一致, false 无法恢复
+   */
+  bool restore_retained_state();
+
+  /**
+   * @brief 将当前状态写入RTC内存快照
+   */
+  void save_retained_state() const;
+
+  /**
+   * @brief 应用电池化学体系预设,覆盖相关配置项
+   */
+  void apply_battery_preset();
+
+  /**
+   * @brief 根据关机时长补偿自放电
+   * @note 需要上次保存时间与当前绝对时间均已知;启动时时间未知则推迟到set_epoch_ms()
+   */
+  void apply_off_period_compensation();
+
+  /**
+   * @brief 计算关机时长
+   * @param out_off_time_s 输出参数,上次保存到本次启动的时长(秒)
+   * @return true 时长已知且合理, false 时间未知或异常
+   */
+  bool get_off_time_s(uint32_t &out_off_time_s);
+
+  /**
+   * @brief 评估启动时开路电压估算的置信度
+   * @param ocv_soc_percent 开路电压估算的SOC(%)
+   * @param boot_abs_current_ma 启动时电流绝对值(mA),带载时电压被拉低
+   * @param is_off_time_known 关机时长是否已知
+   * @param off_time_s 关机时长(秒),决定电压弛豫程度
+   * @return 置信度(0-1)
+   */
+  float calc_ocv_confidence(float ocv_soc_percent, float boot_abs_current_ma, bool is_off_time_known, uint32_t off_time_s) const;
+
+  /**
+   * @brief 在NVS恢复值与开路电压估算值之间仲裁启动SOC
+   * @param ocv_soc_percent 开路电压估算的SOC(%)
+   * @param boot_abs_current_ma 启动时电流绝对值(mA)
+   * @note 两者相差过大且开路电压可信时直接采用开路电压,否则按置信度加权融合
+   */
+  void arbitrate_boot_soc(float ocv_soc_percent, float boot_abs_current_ma);
+
+  /**
+   * @brief 静置足够长时间后按开路电压校准SOC
+   * @param now_ms 当前时间戳(ms)
+   * @param abs_current_ma 当前电流绝对值(mA)
+   * @note 每个静置周期只校准一次,落在开路电压平台区内时跳过
+   */
+  void maybe_recalibrate_at_rest(uint32_t now_ms, float abs_current_ma);
+
+  /**
+   * @brief 静置电流下让运行SOC不高于最弱单节SOC
+   * @param elapsed_ms 距上次积分的时间(ms)
+   * @param abs_current_ma 当前电流绝对值(mA)
+   * @note 只向下修正,按weakest_cell_soc_time_constant_s平滑收敛;最弱单节SOC落在平台区内时跳过,
+   *       平台区外(如磷酸铁锂弱单节先掉出平台)仍会修正
+   */
+  void cap_soc_at_weakest_cell(uint32_t elapsed_ms, float abs_current_ma);
+
+  /**
+   * @brief 按本次有效电流积分剩余容量,并做满充、耗尽与静置校准判断
+   * @param now_ms 当前系统时间戳(ms)
+   * @param abs_current_ma 电流绝对值(mA)
+   * @param effective_current_ma 参与积分的有效电流(mA),放电为正
+   */
+  void update_state_of_charge(uint32_t now_ms, float abs_current_ma, float effective_current_ma);
+
+  /**
+   * @brief 增量更新剩余时间预测(放空/充满时间)
+   * @param elapsed_ms 距离上次更新的时间(ms)
+   * @param current_ma 本次有效电流(mA),放电为正
+   * @note 计算由RuntimePredictor完成,这里只负责填充样本字段
+   */
+  void update_runtime_prediction(uint32_t elapsed_ms, float current_ma);
+
+  /**
+   * @brief 预计算放电倍率修正系数表
+   * @note 在构造时调用一次,之后积分时只需查表插值
+   */
+  void build_rate_factor_table();
+
+  /**
+   * @brief 计算指定放电电流下的等效消耗系数(>=1表示实际消耗多于库仑计数)
+   * @param discharge_current_ma 放电电流(mA),必须为正
+   * @return 等效消耗系数,由Peukert指数或倍率-容量查表决定
+   */
+  float calc_rate_capacity_factor(float discharge_current_ma) const;
+
+  /**
+   * @brief 从预计算表中查找放电倍率修正系数
+   * @param discharge_current_ma 放电电流(mA),必须为正
+   * @return 线性插值得到的修正系数,未启用修正时返回1
+   */
+  float get_rate_capacity_factor(float discharge_current_ma) const;
+
+  /**
+   * @brief 计算当前SOC下的充电效率系数
+   * @return SOC查表插值得到的系数,未提供查表时返回1
+   */
+  float calc_charge_efficiency_factor() const;
+
+  /**
+   * @brief 满充时根据本次满充到满充循环的充放电量学习充电效率
+   */
+  void learn_charge_efficiency_at_full_charge();
+
+  /**
+   * @brief 解析并执行设置时间命令
+   * @param serial 调试串口,命令字符之后为Unix时间(秒),以换行结束
+   */
+  void handle_set_time_command(Stream *serial);
+
+  /**
+   * @brief 以当前样本数据记录一条生命周期事件
+   * @param type 事件类型
+   * @param detail 附加信息
+   */
+  void record_event(BatteryEventType type, uint32_t detail = 0);
+
+  /**
+   * @brief 将一条事件写入事件日志
+   * @param event 事件
+   * @note 写入Flash分区,不能在持有总线时调用
+   */
+  void append_event(const DeferredEvent &event);
+
+  /**
+   * @brief 输出持有总线期间暂存的日志与事件
+   * @note 在释放总线之后调用,串口输出与Flash擦写不再让总线上的其他设备等待
+   */
+  void flush_deferred_output();
+
   /**
    * @brief 格式化输出日志
    * @param format 格式化字符串
    * @param ... 可变参数
+   * @note 持有总线期间暂存,由flush_deferred_output()输出
    */
   void logf(const char *format, ...) const;
 
   static const SocPoint k_default_soc_table_[]; // 默认的SOC查表
+  static RetainedMonitorState retained_state_; // RTC内存中的热重启快照(只有一个,供单个监视器实例使用)
+  static constexpr size_t RATE_FACTOR_TABLE_SIZE = 33; // 放电倍率修正系数表的点数(覆盖0到最大电流)
+  static constexpr size_t LOG_LINE_SIZE = 128; // 单条日志的最大长度(含结尾0)
+  static constexpr uint8_t MAX_DEFERRED_LOGS = 6; // 持有总线期间最多暂存的日志条数(一次更新中全部保护项与量程切换)
+  static constexpr uint8_t MAX_DEFERRED_EVENTS = 6; // 持有总线期间最多暂存的事件条数
 
   Config config_{}; // 配置副本
   Print *logger_ = nullptr; // 日志对象指针
+  CellVoltageMonitor *cell_monitor_ = nullptr; // 单节电压监视器指针
+  TemperatureSource *temperature_source_ = nullptr; // 温度源指针
+  BatteryEventLog *event_log_ = nullptr; // 事件日志指针
+  I2cBusArbiter *bus_arbiter_ = nullptr; // 共享I2C总线仲裁器指针
 
   INA226 ina226_; // INA226驱动实例
-
-  Sample sample_{}; // 最新采样数据
+  INA226 low_range_ina226_; // 双分流模式的低量程INA226驱动实例
+
+  mutable Sample sample_{}; // 最新采样数据,原始寄存器模式下由sample()按需补全
+  mutable bool is_sample_dirty_ = false; // 原始寄存器值是否尚未换算到样本
+
+  uint16_t raw_bus_voltage_ = 0; // 总线电压寄存器原始值(LSB 1.25mV)
+  int16_t raw_shunt_voltage_ = 0; // 分流电压寄存器原始值(LSB 2.5uV)
+  int16_t raw_current_ = 0; // 电流寄存器原始值(LSB为current_lsb_ma_)
+  uint16_t raw_power_ = 0; // 功率寄存器原始值(LSB为25倍电流LSB)
+  bool is_raw_shunt_voltage_fresh_ = false; // 本周期是否读取了分流电压寄存器
+  bool is_raw_power_fresh_ = false; // 本周期是否读取了功率寄存器
+  uint32_t register_read_cycle_ = 0; // 更新计数,用于按分频调度寄存器读取
+  float merged_current_ma_ = 0.0f; // 双分流模式下最近一次合并后的电流(mA),原始寄存器模式换算样本时使用
+
+  bool is_low_range_active_ = false; // 当前是否处于低量程
+  bool is_range_settling_ = false; // 刚切换量程,电流寄存器可能仍按旧校准计算
+  bool is_range_down_pending_ = false; // 是否正在等待切换到低量程
+  uint32_t range_down_since_ms_ = 0; // 电流开始低于切换阈值的时间戳
+  float current_lsb_ma_ = 0.0f; // 电流寄存器LSB(mA)
+  int32_t raw_deadzone_ = 0; // 电流死区(电流LSB)
+  int32_t raw_over_current_ = 0; // 过流阈值(电流LSB),0表示未启用
+  uint16_t raw_under_voltage_ = 0; // 欠压阈值(总线电压LSB),0表示未启用
+  uint16_t raw_under_voltage_release_ = 0; // 欠压解除阈值(总线电压LSB)
+  int64_t raw_charge_accumulator_ = 0; // 未折算的电荷(电流LSB*ms),放电为正
+  uint32_t raw_accumulated_ms_ = 0; // 累加器覆盖的时长(ms)
+  double raw_pending_charge_ma_ms_ = 0.0; // 量程切换时按旧LSB折算出的电荷(mA*ms),等待下次折算
+  uint32_t last_raw_sample_ms_ = 0; // 上次原始采样的时间戳
+  uint32_t last_raw_fold_ms_ = 0; // 上次折算的时间戳
   double remaining_capacity_mah_ = NAN; // 当前剩余容量(mAh)
   float soc_percent_ = NAN; // 当前SOC(%)
 
-  uint32_t last_time_ms_ = 0; // 上次更新的时间戳
+  MonotonicClock clock_{}; // 64位单调时间基准
+  uint64_t last_update_monotonic_ms_ = 0; // 上次积分的单调时间戳
   uint32_t last_nvs_save_ms_ = 0; // 上次NVS保存的时间戳
+  SampleGapStats sample_gap_stats_{}; // 采样间隔诊断统计
+  bool is_output_deferred_ = false; // 是否正持有总线,日志与事件需暂存
+  mutable char deferred_logs_[MAX_DEFERRED_LOGS][LOG_LINE_SIZE] = {}; // 暂存的日志
+  mutable uint8_t deferred_log_count_ = 0; // 暂存的日志条数
+  mutable uint8_t deferred_log_drop_count_ = 0; // 队列满而丢弃的日志条数
+  DeferredEvent deferred_events_[MAX_DEFERRED_EVENTS] = {}; // 暂存的事件
+  uint8_t deferred_event_count_ = 0; // 暂存的事件条数
+  uint8_t deferred_event_drop_count_ = 0; // 队列满而丢弃的事件条数
+  uint32_t last_update_call_ms_ = 0; // 上次调用update()的时间戳
+  bool has_update_call_ = false; // 是否已调用过update()
   double last_saved_remaining_capacity_mah_ = NAN; // 上次保存到NVS的容量值
+  TaskHandle_t nvs_writer_task_ = nullptr; // 后台NVS写入任务,nullptr表示在update()中直接写入
+  portMUX_TYPE nvs_writer_lock_ = portMUX_INITIALIZER_UNLOCKED; // 保护投递状态与写入结果的自旋锁
+  PersistedBatteryState nvs_pending_state_{}; // 投递给写入任务的状态,未写入前被新的投递覆盖
+  bool has_nvs_pending_state_ = false; // 是否有待写入的状态
+  bool has_nvs_result_ = false; // 写入任务是否有未取回的结果
+  bool is_nvs_result_saved_ = false; // 写入任务的结果是否成功
+  uint32_t nvs_result_us_ = 0; // 写入任务的写入耗时(us)
+  uint32_t nvs_result_remaining_mah_x100_ = 0; // 写入任务写入的剩余容量 * 100
+
+  RuntimePredictor runtime_predictor_; // 剩余时间预测器(平滑电流与功率)
+
+  bool is_rate_correction_enabled_ = false; // 是否启用放电倍率修正
+  float rate_factor_step_inv_ = 0.0f; // 修正系数表相邻点电流间隔的倒数(1/mA)
+  float rate_factor_table_[RATE_FACTOR_TABLE_SIZE] = {}; // 预计算的放电倍率修正系数表
+
+  bool is_full_charge_latched_ = false; // 满充事件是否已记录(满充后放出足够电量才复位)
+  bool is_depleted_latched_ = false; // 耗尽事件是否已记录(SOC回升后复位)
+
+  uint32_t last_temperature_request_ms_ = 0; // 上次发起温度测量的时间戳
+  float capacity_temp_factor_ = 1.0f; // 当前温度下的有效容量系数
+  float charge_temp_factor_ = 1.0f; // 当前温度下的充电效率系数
+
+  uint8_t protection_faults_ = 0; // 当前生效的保护故障位
+  bool is_load_enabled_ = true; // 负载开关是否接通
+  volatile bool is_alert_tripped_ = false; // ALERT中断是否已断开负载(由中断置位)
+  volatile uint32_t load_gpio_mask_ = 0; // 负载开关引脚在输出寄存器中的位,供中断直接写寄存器
+  volatile bool is_load_gpio_high_bank_ = false; // 负载开关引脚是否位于GPIO32-39寄存器组
+  ProtectionTimer over_current_timer_{}; // 过流触发计时器
+  ProtectionTimer under_voltage_timer_{}; // 欠压触发计时器
+  ProtectionTimer over_temperature_timer_{}; // 过温触发计时器
+  ProtectionTimer release_timer_{}; // 故障解除恢复计时器
+
+  bool is_off_period_pending_ = false; // 关机期间补偿是否等待绝对时间
+  uint32_t saved_epoch_s_ = 0; // 上次保存到NVS的Unix时间(秒)
+  float off_period_nvs_weight_ = 1.0f; // 启动仲裁后NVS值所占权重,推迟的自放电补偿按此比例施加
+
+  bool is_resting_ = false; // 当前是否处于静置状态
+  bool is_rest_recalibrated_ = false; // 本次静置是否已经校准过
+  uint32_t rest_start_ms_ = 0; // 本次静置开始的时间戳
+
+  float learned_charge_efficiency_ = NAN; // 学习到的基础充电效率,NAN表示未学习
+  bool has_full_charge_reference_ = false; // 是否已经历过一次满充(学习循环的起点)
+  double cycle_charge_in_mah_ = 0.0; // 本循环充入电量(已乘SOC系数,未乘基础效率)
+  double cycle_discharge_out_mah_ = 0.0; // 本循环放出电量(库仑计数,未做倍率修正)
 };
 
@@ -0,0 +1,117 @@
+#include "ina226_sync_group.h" // 包含INA226同步采样组的头文件
+
+#include "i2c_bus_arbiter.h" // 包含I2C总线仲裁器
+
+Ina226SyncGroup::Ina226SyncGroup(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.channel_count > MAX_CHANNELS) // 通道数超出上限
+  {
+    config_.channel_count = MAX_CHANNELS; // 限制为上限
+  }
+}
+
+bool Ina226SyncGroup::begin()
+{
+  is_ready_ = false; // 先标记未就绪
+  if (config_.channel_count == 0) // 未配置通道
+  {
+    return false; // 返回失败
+  }
+
+  I2cBusLock bus_lock(config_.bus_arbiter, true); // 初始化期间占用共享总线
+  if (!bus_lock.is_locked()) // 获取总线失败
+  {
+    return false; // 返回失败
+  }
+  for (uint8_t i = 0; i < config_.channel_count; i++) // 检查每个通道
+  {
+    if (config_.sensors[i] == nullptr || !config_.sensors[i]->isConnected()) // 传感器为空或无响应
+    {
+      return false; // 返回失败
+    }
+    if (config_.current_polarity[i] != -1) // 极性只允许1或-1
+    {
+      config_.current_polarity[i] = 1; // 修正为正极性
+    }
+  }
+  is_ready_ = true; // 标记就绪
+  return true; // 初始化成功
+}
+
+bool Ina226SyncGroup::capture(Frame &out_frame)
+{
+  if (!is_ready_) // 未初始化
+  {
+    return false; // 返回失败
+  }
+
+  {
+    I2cBusLock trigger_lock(config_.bus_arbiter, true); // 触发期间以高优先级占用总线,保证触发命令背靠背发出
+    if (!trigger_lock.is_locked()) // 获取总线超时
+    {
+      return false; // 返回失败
+    }
+    const uint32_t first_trigger_us = micros(); // 第一个通道的触发时间
+    for (uint8_t i = 0; i < config_.channel_count; i++) // 依次触发
+    {
+      if (!config_.sensors[i]->setModeShuntBusTrigger()) // 写配置寄存器发起单次转换(同时清除转换就绪标志)
+      {
+        return false; // 写入失败
+      }
+    }
+    out_frame.trigger_skew_us = micros() - first_trigger_us; // 触发时间差
+    out_frame.timestamp_ms = millis(); // 全部通道共用的时间戳
+  }
+
+  const uint8_t all_done_mask = static_cast<uint8_t>((1u << config_.channel_count) - 1u); // 全部通道完成时的掩码
+  uint8_t done_mask = 0; // 已完成转换的通道;读取Mask/Enable寄存器会清除转换就绪标志,完成后不再轮询
+  const uint32_t wait_start_ms = millis(); // 等待起点
+  while (done_mask != all_done_mask) // 各芯片内部时钟有误差,先触发的通道不一定先完成,需逐个确认
+  {
+    {
+      I2cBusLock poll_lock(config_.bus_arbiter, false); // 每轮轮询单独占用总线,转换期间其他设备可以使用总线
+      if (!poll_lock.is_locked()) // 获取总线超时
+      {
+        return false; // 返回失败
+      }
+      for (uint8_t i = 0; i < config_.channel_count; i++) // 轮询尚未完成的通道
+      {
+        const uint8_t channel_bit = static_cast<uint8_t>(1u << i); // 通道对应的位
+        if ((done_mask & channel_bit) == 0 && config_.sensors[i]->isConversionReady()) // 本轮完成
+        {
+          done_mask |= channel_bit; // 记录完成
+        }
+      }
+    }
+    if (done_mask != all_done_mask) // 尚有通道未完成
+    {
+      if ((millis() - wait_start_ms) >= config_.conversion_timeout_ms) // 超时
+      {
+        return false; // 转换超时
+      }
+      delay(1); // 等待后再轮询
+    }
+  }
+
+  I2cBusLock read_lock(config_.bus_arbiter, false); // 读取期间占用总线
+  if (!read_lock.is_locked()) // 获取总线超时
+  {
+    return false; // 返回失败
+  }
+  for (uint8_t i = 0; i < config_.channel_count; i++) // 读取结果
+  {
+    INA226 *sensor = config_.sensors[i]; // 当前通道
+    out_frame.bus_voltage_v[i] = sensor->getBusVoltage(); // 读取总线电压
+    out_frame.shunt_voltage_mv[i] = sensor->getShuntVoltage_mV(); // 读取分流电压
+    out_frame.current_ma[i] = static_cast<float>(config_.current_polarity[i]) * sensor->getCurrent_mA(); // 读取电流并应用极性
+    out_frame.power_mw[i] = sensor->getPower_mW(); // 读取功率
+  }
+  out_frame.channel_count = config_.channel_count; // 记录通道数
+  return true; // 采集成功
+}
+
+uint8_t Ina226SyncGroup::get_channel_count() const
+{
+  return config_.channel_count; // 返回通道数
+}
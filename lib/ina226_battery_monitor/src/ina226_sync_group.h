@@ -0,0 +1,74 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <INA226.h> // 包含INA226驱动库
+
+class I2cBusArbiter; // I2C总线仲裁器(前置声明)
+
+/**
+ * @brief 多个INA226的同步触发采样组
+ * @note 连续向各通道写入单次触发命令,等待全部通道转换完成后再依次读取结果,
+ *       得到同一时刻的多通道帧;用于跨电源轨计算总功率或效率
+ * @note 组内传感器由本类切换为单次触发模式,不应再被其他代码以连续模式读取
+ */
+class Ina226SyncGroup
+{
+public:
+  static constexpr uint8_t MAX_CHANNELS = 4; // 支持的最大通道数
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    uint8_t channel_count = 0; // 通道数(1-MAX_CHANNELS)
+    INA226 *sensors[MAX_CHANNELS] = {}; // 各通道的INA226,需由调用者完成校准(setMaxCurrentShunt)
+    int8_t current_polarity[MAX_CHANNELS] = {1, 1, 1, 1}; // 各通道电流极性(1 或 -1)
+    uint32_t conversion_timeout_ms = 100; // 等待转换完成的超时时间(ms),需大于平均点数*(总线+分流转换时间)
+    I2cBusArbiter *bus_arbiter = nullptr; // 共享I2C总线仲裁器,nullptr表示独占总线
+  };
+
+  /**
+   * @brief 同步采样帧
+   */
+  struct Frame
+  {
+    uint32_t timestamp_ms = 0; // 触发时刻的系统时间戳(ms),全部通道共用
+    uint32_t trigger_skew_us = 0; // 第一个与最后一个通道触发之间的间隔(us)
+    uint8_t channel_count = 0; // 有效通道数
+    float bus_voltage_v[MAX_CHANNELS] = {}; // 各通道总线电压(V)
+    float shunt_voltage_mv[MAX_CHANNELS] = {}; // 各通道分流电压(mV)
+    float current_ma[MAX_CHANNELS] = {}; // 各通道电流(mA),已应用极性
+    float power_mw[MAX_CHANNELS] = {}; // 各通道功率(mW)
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit Ina226SyncGroup(const Config &config);
+
+  /**
+   * @brief 初始化采样组
+   * @return true 初始化成功, false 配置无效或传感器无响应
+   * @note 需要在I2C总线初始化之后调用;各通道应使用相同的平均点数与转换时间,否则等待时间以最慢通道为准
+   */
+  bool begin();
+
+  /**
+   * @brief 同步采集一帧
+   * @param out_frame 输出参数,采样帧
+   * @return true 采集成功, false 转换超时或未初始化
+   */
+  bool capture(Frame &out_frame);
+
+  /**
+   * @brief 获取通道数
+   * @return 通道数
+   */
+  uint8_t get_channel_count() const;
+
+private:
+  Config config_{}; // 配置副本
+  bool is_ready_ = false; // 是否已成功初始化
+};
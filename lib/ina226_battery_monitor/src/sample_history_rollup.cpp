@@ -0,0 +1,173 @@
+#include "sample_history_rollup.h" // 包含采样历史汇总的头文件
+
+#include <math.h> // 包含数学库
+
+SampleHistoryRollup::SampleHistoryRollup(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.tier_count > MAX_TIERS) // 级数超出上限
+  {
+    config_.tier_count = MAX_TIERS; // 限制为上限
+  }
+}
+
+bool SampleHistoryRollup::begin()
+{
+  is_ready_ = false; // 先标记未就绪
+  if (config_.tier_count == 0) // 未配置级数
+  {
+    return false; // 返回失败
+  }
+  for (uint8_t i = 0; i < config_.tier_count; i++) // 检查每一级
+  {
+    const uint32_t duration_ms = config_.tiers[i].bucket_duration_ms; // 桶时长
+    if (duration_ms == 0) // 桶时长无效
+    {
+      return false; // 返回失败
+    }
+    if (i > 0 && duration_ms % config_.tiers[i - 1].bucket_duration_ms != 0) // 不是上一级的整数倍,桶边界无法对齐
+    {
+      return false; // 返回失败
+    }
+    if (config_.tiers[i].buckets == nullptr) // 不保存
+    {
+      config_.tiers[i].bucket_count = 0; // 容量视为0
+    }
+    accumulators_[i] = Accumulator{}; // 清空累加器
+  }
+  has_last_sample_ = false; // 重新开始
+  is_ready_ = true; // 标记就绪
+  return true; // 初始化成功
+}
+
+void SampleHistoryRollup::add_sample(const Ina226BatteryMonitor::Sample &sample)
+{
+  if (!is_ready_ || isnan(sample.bus_voltage_v) || isnan(sample.current_ma)) // 未初始化或样本无效
+  {
+    return; // 忽略
+  }
+  if (has_last_sample_ && sample.timestamp_ms == last_sample_ms_) // 监视器未产生新样本
+  {
+    return; // 忽略重复样本
+  }
+
+  Bucket part{}; // 单个样本视为样本数为1的桶
+  part.sample_count = 1; // 样本数
+  part.min_bus_voltage_v = sample.bus_voltage_v; // 最低电压
+  part.max_bus_voltage_v = sample.bus_voltage_v; // 最高电压
+  part.mean_bus_voltage_v = sample.bus_voltage_v; // 平均电压
+  part.last_bus_voltage_v = sample.bus_voltage_v; // 最后电压
+  part.min_current_ma = sample.current_ma; // 最小电流
+  part.max_current_ma = sample.current_ma; // 最大电流
+  part.mean_current_ma = sample.current_ma; // 平均电流
+  part.last_current_ma = sample.current_ma; // 最后电流
+  if (has_last_sample_ && sample.timestamp_ms > last_sample_ms_ && (sample.timestamp_ms - last_sample_ms_) <= config_.max_sample_gap_ms) // 间隔有效时累计电荷
+  {
+    const double hours_passed = static_cast<double>(sample.timestamp_ms - last_sample_ms_) / 3600000.0; // 将毫秒转换为小时
+    part.charge_mah = static_cast<float>(static_cast<double>(sample.current_ma) * hours_passed); // 本样本代表的电荷
+  }
+  has_last_sample_ = true; // 标记已加入
+  last_sample_ms_ = sample.timestamp_ms; // 记录时间戳
+
+  merge_into_tier(0, sample.timestamp_ms, part); // 只更新最细一级,粗级在桶结束时逐级合并
+}
+
+uint16_t SampleHistoryRollup::get_bucket_count(uint8_t tier) const
+{
+  if (tier >= config_.tier_count) // 级序号无效
+  {
+    return 0; // 返回0
+  }
+  return accumulators_[tier].stored_count; // 返回已保存的桶数
+}
+
+bool SampleHistoryRollup::get_bucket(uint8_t tier, uint16_t index, Bucket &out_bucket) const
+{
+  if (tier >= config_.tier_count || index >= accumulators_[tier].stored_count) // 序号无效
+  {
+    return false; // 返回失败
+  }
+  const Accumulator &accumulator = accumulators_[tier]; // 该级累加器
+  const uint16_t capacity = config_.tiers[tier].bucket_count; // 环形缓冲容量
+  const uint32_t oldest = (static_cast<uint32_t>(accumulator.write_index) + capacity - accumulator.stored_count) % capacity; // 最早桶的下标
+  out_bucket = config_.tiers[tier].buckets[(oldest + index) % capacity]; // 复制桶
+  return true; // 读取成功
+}
+
+bool SampleHistoryRollup::get_open_bucket(uint8_t tier, Bucket &out_bucket) const
+{
+  if (tier >= config_.tier_count || !accumulators_[tier].is_open) // 序号无效或无未结束的桶
+  {
+    return false; // 返回失败
+  }
+  out_bucket = finalize_bucket(accumulators_[tier]); // 按已有样本计算
+  return true; // 读取成功
+}
+
+void SampleHistoryRollup::merge_into_tier(uint8_t tier, uint64_t timestamp_ms, const Bucket &part)
+{
+  Accumulator &accumulator = accumulators_[tier]; // 该级累加器
+  const uint64_t bucket_index = timestamp_ms / config_.tiers[tier].bucket_duration_ms; // 数据所属的桶
+  if (accumulator.is_open && accumulator.bucket_index != bucket_index) // 跨越桶边界(时间基准切换时也可能回退)
+  {
+    close_bucket(tier); // 先结束当前桶
+  }
+
+  Bucket &bucket = accumulator.bucket; // 当前桶
+  if (!accumulator.is_open) // 开始新桶
+  {
+    accumulator.is_open = true; // 标记已开始
+    accumulator.bucket_index = bucket_index; // 记录桶序号
+    accumulator.bus_voltage_sum = 0.0; // 清空累加和
+    accumulator.current_sum = 0.0; // 清空累加和
+    bucket = part; // 以第一段数据初始化最值与最后值
+    bucket.start_s = static_cast<uint32_t>(bucket_index * config_.tiers[tier].bucket_duration_ms / 1000); // 桶开始时间
+  }
+  else
+  {
+    bucket.sample_count += part.sample_count; // 累计样本数
+    bucket.min_bus_voltage_v = part.min_bus_voltage_v < bucket.min_bus_voltage_v ? part.min_bus_voltage_v : bucket.min_bus_voltage_v; // 更新最低电压
+    bucket.max_bus_voltage_v = part.max_bus_voltage_v > bucket.max_bus_voltage_v ? part.max_bus_voltage_v : bucket.max_bus_voltage_v; // 更新最高电压
+    bucket.last_bus_voltage_v = part.last_bus_voltage_v; // 更新最后电压
+    bucket.min_current_ma = part.min_current_ma < bucket.min_current_ma ? part.min_current_ma : bucket.min_current_ma; // 更新最小电流
+    bucket.max_current_ma = part.max_current_ma > bucket.max_current_ma ? part.max_current_ma : bucket.max_current_ma; // 更新最大电流
+    bucket.last_current_ma = part.last_current_ma; // 更新最后电流
+    bucket.charge_mah += part.charge_mah; // 累计电荷
+  }
+  accumulator.bus_voltage_sum += static_cast<double>(part.mean_bus_voltage_v) * part.sample_count; // 按样本数加权
+  accumulator.current_sum += static_cast<double>(part.mean_current_ma) * part.sample_count; // 按样本数加权
+}
+
+void SampleHistoryRollup::close_bucket(uint8_t tier)
+{
+  Accumulator &accumulator = accumulators_[tier]; // 该级累加器
+  const Bucket closed = finalize_bucket(accumulator); // 计算平均值
+  accumulator.is_open = false; // 结束当前桶
+
+  const TierConfig &tier_config = config_.tiers[tier]; // 该级配置
+  if (tier_config.bucket_count > 0) // 保存到环形缓冲
+  {
+    tier_config.buckets[accumulator.write_index] = closed; // 写入桶
+    accumulator.write_index = (accumulator.write_index + 1) % tier_config.bucket_count; // 环形前进,满后覆盖最早的桶
+    if (accumulator.stored_count < tier_config.bucket_count) // 未满
+    {
+      accumulator.stored_count++; // 累计桶数
+    }
+  }
+
+  if (tier + 1 < config_.tier_count) // 合并到下一级
+  {
+    merge_into_tier(tier + 1, static_cast<uint64_t>(accumulator.bucket_index) * tier_config.bucket_duration_ms, closed); // 以桶开始时间定位下一级的桶
+  }
+}
+
+SampleHistoryRollup::Bucket SampleHistoryRollup::finalize_bucket(const Accumulator &accumulator)
+{
+  Bucket bucket = accumulator.bucket; // 复制最值、最后值与电荷
+  if (bucket.sample_count > 0) // 有样本
+  {
+    bucket.mean_bus_voltage_v = static_cast<float>(accumulator.bus_voltage_sum / bucket.sample_count); // 平均电压
+    bucket.mean_current_ma = static_cast<float>(accumulator.current_sum / bucket.sample_count); // 平均电流
+  }
+  return bucket; // 返回桶
+}
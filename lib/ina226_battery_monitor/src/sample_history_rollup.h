@@ -0,0 +1,141 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+
+#include "ina226_battery_monitor.h" // 包含INA226电池监视器的头文件
+
+/**
+ * @brief 多分辨率的采样历史汇总(如1s / 1min / 1h)
+ * @note 每个样本只更新最细一级的累加器;桶结束时写入该级的环形缓冲并合并到下一级,
+ *       每个样本的开销与历史长度无关
+ * @note 各级的桶数组由调用者提供,容量决定保留时长(如1440个分钟桶为一天,720个小时桶为一个月)
+ */
+class SampleHistoryRollup
+{
+public:
+  static constexpr uint8_t MAX_TIERS = 3; // 支持的最大级数
+
+  /**
+   * @brief 汇总桶
+   */
+  struct Bucket
+  {
+    uint32_t start_s = 0; // 桶开始时间(s),与样本时间戳同一时间基准
+    uint32_t sample_count = 0; // 桶内样本数
+    float min_bus_voltage_v = 0.0f; // 最低总线电压(V)
+    float max_bus_voltage_v = 0.0f; // 最高总线电压(V)
+    float mean_bus_voltage_v = 0.0f; // 平均总线电压(V)
+    float last_bus_voltage_v = 0.0f; // 最后一个样本的总线电压(V)
+    float min_current_ma = 0.0f; // 最小电流(mA)
+    float max_current_ma = 0.0f; // 最大电流(mA)
+    float mean_current_ma = 0.0f; // 平均电流(mA)
+    float last_current_ma = 0.0f; // 最后一个样本的电流(mA)
+    float charge_mah = 0.0f; // 桶内电荷(mAh),放电为正
+  };
+
+  /**
+   * @brief 单级配置
+   */
+  struct TierConfig
+  {
+    uint32_t bucket_duration_ms = 0; // 桶时长(ms),需为上一级的整数倍
+    Bucket *buckets = nullptr; // 调用者提供的桶数组,nullptr表示该级只参与逐级合并而不保存
+    uint16_t bucket_count = 0; // 桶数组容量
+  };
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    uint8_t tier_count = 0; // 级数(1-MAX_TIERS)
+    TierConfig tiers[MAX_TIERS] = {{1000, nullptr, 0}, {60000, nullptr, 0}, {3600000, nullptr, 0}}; // 各级配置,由细到粗
+    uint32_t max_sample_gap_ms = 5000; // 相邻样本间隔超过此值(ms)时不累计电荷,避免停采期间按旧电流外推
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit SampleHistoryRollup(const Config &config);
+
+  /**
+   * @brief 检查配置
+   * @return true 配置有效, false 级数为0、桶时长为0或不是上一级的整数倍
+   */
+  bool begin();
+
+  /**
+   * @brief 加入一个样本
+   * @param sample 采样数据
+   * @note 时间戳与上一个样本相同(监视器未产生新样本)或电压、电流无效时忽略
+   */
+  void add_sample(const Ina226BatteryMonitor::Sample &sample);
+
+  /**
+   * @brief 获取某一级已保存的桶数
+   * @param tier 级序号(0为最细)
+   * @return 桶数
+   */
+  uint16_t get_bucket_count(uint8_t tier) const;
+
+  /**
+   * @brief 按时间顺序读取某一级已保存的桶
+   * @param tier 级序号
+   * @param index 桶序号(0为最早)
+   * @param out_bucket 输出参数,桶
+   * @return true 读取成功, false 序号无效
+   */
+  bool get_bucket(uint8_t tier, uint16_t index, Bucket &out_bucket) const;
+
+  /**
+   * @brief 读取某一级尚未结束的桶
+   * @param tier 级序号
+   * @param out_bucket 输出参数,桶(平均值按已有样本计算)
+   * @return true 有未结束的桶, false 无
+   * @note 粗级的未结束桶只包含已结束的细级桶,不含细级尚未结束的部分
+   */
+  bool get_open_bucket(uint8_t tier, Bucket &out_bucket) const;
+
+private:
+  /**
+   * @brief 单级累加器
+   */
+  struct Accumulator
+  {
+    bool is_open = false; // 是否有未结束的桶
+    uint64_t bucket_index = 0; // 当前桶序号(时间戳/桶时长)
+    Bucket bucket{}; // 当前桶(最值、最后值与电荷)
+    double bus_voltage_sum = 0.0; // 电压按样本数加权的和
+    double current_sum = 0.0; // 电流按样本数加权的和
+    uint16_t write_index = 0; // 环形缓冲的下一个写入位置
+    uint16_t stored_count = 0; // 环形缓冲中已保存的桶数
+  };
+
+  /**
+   * @brief 将一段数据合并到某一级,跨越桶边界时先结束当前桶
+   * @param tier 级序号
+   * @param timestamp_ms 数据的时间戳(ms)
+   * @param part 待合并的数据(单个样本视为样本数为1的桶)
+   */
+  void merge_into_tier(uint8_t tier, uint64_t timestamp_ms, const Bucket &part);
+
+  /**
+   * @brief 结束某一级的当前桶:写入环形缓冲并合并到下一级
+   * @param tier 级序号
+   */
+  void close_bucket(uint8_t tier);
+
+  /**
+   * @brief 按累加和计算平均值,得到完整的桶
+   * @param accumulator 累加器
+   * @return 桶
+   */
+  static Bucket finalize_bucket(const Accumulator &accumulator);
+
+  Config config_{}; // 配置副本
+  bool is_ready_ = false; // 是否已成功初始化
+  Accumulator accumulators_[MAX_TIERS] = {}; // 各级累加器
+  bool has_last_sample_ = false; // 是否已加入过样本
+  uint64_t last_sample_ms_ = 0; // 上一个样本的时间戳
+};
@@ -0,0 +1,141 @@
+#include "sample_text_formatter.h" // 包含采样数据文本格式化器的头文件
+
+#include <math.h> // 包含数学库
+
+static constexpr uint8_t k_max_decimals = 6; // 支持的最大小数位数
+static constexpr double k_max_magnitude = 4294967040.0; // 与Print::printFloat相同的溢出界限,加上舍入量后仍在32位范围内
+
+/**
+ * @brief 复制一段文本到缓冲区
+ * @param out 输出缓冲区
+ * @param capacity 缓冲区大小(含结尾0)
+ * @param text 以0结尾的文本
+ * @return 写入的字符数(不含结尾0)
+ */
+static size_t copy_text(char *out, size_t capacity, const char *text)
+{
+  size_t length = 0; // 已写入长度
+  while (text[length] != '\0' && length + 1 < capacity) // 保留结尾0的位置
+  {
+    out[length] = text[length]; // 复制字符
+    length++; // 前进
+  }
+  out[length] = '\0'; // 结尾0
+  return length; // 返回长度
+}
+
+size_t format_fixed_point(char *out, size_t capacity, float value, uint8_t decimals)
+{
+  if (capacity == 0) // 无空间
+  {
+    return 0; // 直接返回
+  }
+  if (isnan(value)) // 非数
+  {
+    return copy_text(out, capacity, "nan"); // 输出nan
+  }
+  if (decimals > k_max_decimals) // 限制小数位数
+  {
+    decimals = k_max_decimals; // 修正为最大值
+  }
+
+  double number = value; // 与Print::printFloat相同,在double中舍入,超过2^24的值不丢失整数位
+  if (isinf(number)) // 无穷大
+  {
+    return copy_text(out, capacity, "inf"); // 输出inf
+  }
+  if (number > k_max_magnitude || number < -k_max_magnitude) // 超出32位范围
+  {
+    return copy_text(out, capacity, "ovf"); // 输出ovf
+  }
+  const bool is_negative = number < 0.0; // 是否为负数,与Print一致,舍入为0时同样输出负号
+  if (is_negative)
+  {
+    number = -number; // 取绝对值
+  }
+  double rounding = 0.5; // 舍入量
+  for (uint8_t i = 0; i < decimals; i++) // 舍入到最后一位小数
+  {
+    rounding /= 10.0; // 右移一位
+  }
+  number += rounding; // 四舍五入
+  uint32_t integer_part = static_cast<uint32_t>(number); // 整数部分
+  double remainder = number - static_cast<double>(integer_part); // 小数部分
+
+  char digits[12]; // 整数部分的逆序数字缓冲
+  size_t digit_count = 0; // 数字个数
+  do
+  {
+    digits[digit_count++] = static_cast<char>('0' + integer_part % 10); // 取最低位
+    integer_part /= 10; // 右移一位
+  } while (integer_part != 0); // 至少输出一位整数
+
+  size_t length = 0; // 已写入长度
+  if (is_negative && length + 1 < capacity) // 负号
+  {
+    out[length++] = '-'; // 写入负号
+  }
+  while (digit_count > 0 && length + 1 < capacity) // 从高位到低位输出整数部分
+  {
+    out[length++] = digits[--digit_count]; // 写入数字
+  }
+  if (decimals > 0 && length + 1 < capacity) // 小数点
+  {
+    out[length++] = '.'; // 写入小数点
+  }
+  for (uint8_t i = 0; i < decimals && length + 1 < capacity; i++) // 逐位取出小数,与Print的取位方式一致
+  {
+    remainder *= 10.0; // 左移一位
+    const uint8_t digit = static_cast<uint8_t>(remainder); // 当前位
+    out[length++] = static_cast<char>('0' + digit); // 写入数字
+    remainder -= digit; // 去掉当前位
+  }
+  out[length] = '\0'; // 结尾0
+  return length; // 返回长度
+}
+
+FixedPointText::FixedPointText(float value, uint8_t decimals)
+{
+  format_fixed_point(text_, sizeof(text_), value, decimals); // 格式化到内部缓冲
+}
+
+const char *FixedPointText::c_str() const
+{
+  return text_; // 返回文本
+}
+
+size_t SampleTextFormatter::format(const Ina226BatteryMonitor::Sample &sample)
+{
+  length_ = 0; // 清空行缓冲
+  append_fixed(sample.bus_voltage_v, 3); // 总线电压(V)
+  append_text("\t"); // 分隔符
+  append_fixed(fabsf(sample.current_ma), 3); // 电流绝对值(mA)
+  append_text("\t"); // 分隔符
+  append_fixed(sample.power_mw, 2); // 功率(mW)
+  append_text("\t"); // 分隔符
+  append_fixed(sample.power2_mw, 2); // 计算功率(mW)
+  append_text("\t"); // 分隔符
+  append_fixed(sample.soc_percent, 3); // SOC(%)
+  append_text(" %\t\r\n"); // 单位与行尾
+  return length_; // 返回行长度
+}
+
+const char *SampleTextFormatter::get_line() const
+{
+  return line_; // 返回行缓冲
+}
+
+size_t SampleTextFormatter::get_length() const
+{
+  return length_; // 返回行长度
+}
+
+void SampleTextFormatter::append_text(const char *text)
+{
+  length_ += copy_text(line_ + length_, sizeof(line_) - length_, text); // 追加文本
+}
+
+void SampleTextFormatter::append_fixed(float value, uint8_t decimals)
+{
+  length_ += format_fixed_point(line_ + length_, sizeof(line_) - length_, value, decimals); // 追加定点数
+}
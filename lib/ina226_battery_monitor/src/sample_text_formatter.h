@@ -0,0 +1,88 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+
+#include "ina226_battery_monitor.h" // 包含INA226电池监视器的头文件
+
+/**
+ * @brief 将浮点数按定点格式写入字符缓冲区
+ * @param out 输出缓冲区
+ * @param capacity 缓冲区大小(含结尾0)
+ * @param value 数值
+ * @param decimals 小数位数(0-6)
+ * @return 写入的字符数(不含结尾0),空间不足时截断
+ * @note 按Print::print(float, n)的算法在double中舍入并逐位输出,结果与之逐字节一致,不依赖printf的浮点支持;
+ *       NAN输出"nan",无穷大输出"inf",绝对值超过4294967040输出"ovf"
+ */
+size_t format_fixed_point(char *out, size_t capacity, float value, uint8_t decimals);
+
+/**
+ * @brief 定点格式的临时文本,用于在日志格式串中以%s输出浮点数
+ * @note 作为函数参数的临时对象在整个表达式结束前有效
+ */
+class FixedPointText
+{
+public:
+  /**
+   * @brief 构造并格式化
+   * @param value 数值
+   * @param decimals 小数位数
+   */
+  FixedPointText(float value, uint8_t decimals);
+
+  /**
+   * @brief 获取格式化后的文本
+   * @return 以0结尾的字符串
+   */
+  const char *c_str() const;
+
+private:
+  char text_[20]; // 文本缓冲,可容纳负号、10位整数、小数点与6位小数
+};
+
+/**
+ * @brief 采样数据的文本行格式化器
+ * @note 所有字段由定点整数渲染到同一个预分配的行缓冲,调用者一次写出整行
+ */
+class SampleTextFormatter
+{
+public:
+  static constexpr size_t LINE_BUFFER_SIZE = 96; // 行缓冲大小
+
+  /**
+   * @brief 格式化一行采样数据
+   * @param sample 采样数据
+   * @return 行长度(字节)
+   * @note 格式为"电压\t电流\t功率\t计算功率\tSOC %\t\r\n",电流输出绝对值
+   */
+  size_t format(const Ina226BatteryMonitor::Sample &sample);
+
+  /**
+   * @brief 获取最近一次格式化的行
+   * @return 行缓冲指针,以0结尾
+   */
+  const char *get_line() const;
+
+  /**
+   * @brief 获取最近一次格式化的行长度
+   * @return 行长度(字节)
+   */
+  size_t get_length() const;
+
+private:
+  /**
+   * @brief 追加一段文本
+   * @param text 以0结尾的文本
+   */
+  void append_text(const char *text);
+
+  /**
+   * @brief 追加一个定点数
+   * @param value 数值
+   * @param decimals 小数位数
+   */
+  void append_fixed(float value, uint8_t decimals);
+
+  char line_[LINE_BUFFER_SIZE] = {}; // 行缓冲
+  size_t length_ = 0; // 当前行长度
+};
@@ -0,0 +1,152 @@
+#include "temperature_source.h" // 包含温度源的头文件
+
+#include <math.h> // 包含数学库
+
+static constexpr uint8_t k_lm75_temperature_register = 0x00; // LM75/TMP102温度寄存器地址
+
+// 内置10k B3950 NTC阻值-温度查表
+const NtcAdcTemperatureSource::NtcPoint NtcAdcTemperatureSource::k_default_ntc_table_[] = {
+    {97060.0f, -20.0f}, // -20°C
+    {55330.0f, -10.0f}, // -10°C
+    {32650.0f, 0.0f},   // 0°C
+    {19900.0f, 10.0f},  // 10°C
+    {12490.0f, 20.0f},  // 20°C
+    {10000.0f, 25.0f},  // 25°C
+    {8060.0f, 30.0f},   // 30°C
+    {5330.0f, 40.0f},   // 40°C
+    {3600.0f, 50.0f},   // 50°C
+    {2490.0f, 60.0f},   // 60°C
+    {1750.0f, 70.0f},   // 70°C
+    {1260.0f, 80.0f},   // 80°C
+};
+
+NtcAdcTemperatureSource::NtcAdcTemperatureSource(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.ntc_table == nullptr || config_.ntc_table_len < 2) // 未提供有效查表
+  {
+    config_.ntc_table = k_default_ntc_table_; // 使用内置查表
+    config_.ntc_table_len = sizeof(k_default_ntc_table_) / sizeof(k_default_ntc_table_[0]); // 内置查表长度
+  }
+  if (config_.oversample_count == 0) // 过采样次数无效
+  {
+    config_.oversample_count = 1; // 至少采样一次
+  }
+  if (config_.reads_per_poll == 0) // 每次poll读取次数无效
+  {
+    config_.reads_per_poll = 1; // 至少读取一次
+  }
+}
+
+bool NtcAdcTemperatureSource::begin()
+{
+  analogSetPinAttenuation(config_.adc_pin, ADC_11db); // 设置衰减以覆盖完整分压范围
+  return true; // 初始化成功
+}
+
+void NtcAdcTemperatureSource::start_measurement()
+{
+  is_measuring_ = true; // 标记测量进行中
+  sample_count_ = 0; // 清零采样计数
+  millivolt_sum_ = 0; // 清零电压累计
+}
+
+bool NtcAdcTemperatureSource::poll(float &out_temperature_c)
+{
+  if (!is_measuring_) // 没有进行中的测量
+  {
+    return false; // 直接返回
+  }
+
+  for (uint8_t i = 0; i < config_.reads_per_poll && sample_count_ < config_.oversample_count; i++) // 每次只读取少量样本
+  {
+    millivolt_sum_ += analogReadMilliVolts(config_.adc_pin); // 读取经校准的电压
+    sample_count_++; // 采样计数加一
+  }
+  if (sample_count_ < config_.oversample_count) // 过采样未完成
+  {
+    return false; // 下次继续
+  }
+
+  is_measuring_ = false; // 测量结束
+  const float millivolts = static_cast<float>(millivolt_sum_) / static_cast<float>(sample_count_); // 平均电压
+  if (millivolts <= 0.0f || millivolts >= config_.supply_mv) // 开路或短路
+  {
+    return false; // 丢弃本次测量
+  }
+
+  const float resistance_ohm = config_.series_resistor_ohm * millivolts / (config_.supply_mv - millivolts); // 分压公式求NTC阻值
+  out_temperature_c = get_temperature_from_resistance(resistance_ohm); // 查表换算温度
+  return true; // 测量完成
+}
+
+float NtcAdcTemperatureSource::get_temperature_from_resistance(float resistance_ohm) const
+{
+  const NtcPoint *table = config_.ntc_table; // 查表指针
+  const size_t table_len = config_.ntc_table_len; // 查表长度
+  if (resistance_ohm >= table[0].resistance_ohm) // 高于最大阻值(最低温度)
+    return table[0].temperature_c; // 返回最低温度
+  if (resistance_ohm <= table[table_len - 1].resistance_ohm) // 低于最小阻值(最高温度)
+    return table[table_len - 1].temperature_c; // 返回最高温度
+
+  for (size_t i = 0; i + 1 < table_len; i++) // 遍历表格区间
+  {
+    const float high_r = table[i].resistance_ohm; // 区间高阻值
+    const float low_r = table[i + 1].resistance_ohm; // 区间低阻值
+    if (resistance_ohm <= high_r && resistance_ohm > low_r) // 找到所在区间
+    {
+      const float ratio = (high_r - resistance_ohm) / (high_r - low_r); // 区间内位置
+      return table[i].temperature_c + ratio * (table[i + 1].temperature_c - table[i].temperature_c); // 线性插值
+    }
+  }
+
+  return table[table_len - 1].temperature_c; // 默认返回最高温度
+}
+
+Lm75TemperatureSource::Lm75TemperatureSource(uint8_t i2c_address, TwoWire *wire)
+    : i2c_address_(i2c_address), // 初始化I2C地址
+      wire_(wire != nullptr ? wire : &Wire) // 初始化I2C总线,默认Wire
+{
+}
+
+bool Lm75TemperatureSource::begin()
+{
+  wire_->beginTransmission(i2c_address_); // 探测传感器
+  return wire_->endTransmission() == 0; // 有应答表示在线
+}
+
+void Lm75TemperatureSource::start_measurement()
+{
+  is_measuring_ = true; // 传感器连续转换,下次poll直接读取
+}
+
+bool Lm75TemperatureSource::poll(float &out_temperature_c)
+{
+  if (!is_measuring_) // 没有待读取的测量
+  {
+    return false; // 直接返回
+  }
+
+  is_measuring_ = false; // 无论成功与否只读取一次
+  return read_temperature(out_temperature_c); // 读取温度寄存器
+}
+
+bool Lm75TemperatureSource::read_temperature(float &out_temperature_c)
+{
+  wire_->beginTransmission(i2c_address_); // 开始传输
+  wire_->write(k_lm75_temperature_register); // 选择温度寄存器
+  if (wire_->endTransmission(false) != 0) // 发送寄存器地址(重复起始)
+  {
+    return false; // 无应答
+  }
+  if (wire_->requestFrom(i2c_address_, static_cast<uint8_t>(2)) != 2) // 读取两个字节
+  {
+    return false; // 读取失败
+  }
+
+  const uint8_t msb = static_cast<uint8_t>(wire_->read()); // 高字节
+  const uint8_t lsb = static_cast<uint8_t>(wire_->read()); // 低字节
+  const int16_t raw = static_cast<int16_t>((static_cast<uint16_t>(msb) << 8) | lsb); // 左对齐的补码温度
+  out_temperature_c = static_cast<float>(raw) / 256.0f; // LM75(9-11位)与TMP102(12位)均为左对齐,高字节为整数部分
+  return true; // 读取成功
+}
@@ -0,0 +1,119 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <Wire.h> // 包含I2C库
+
+/**
+ * @brief 温度源接口
+ * @note 测量分为发起和推进两步,poll()每次只做少量工作,不阻塞电流采样
+ */
+class TemperatureSource
+{
+public:
+  virtual ~TemperatureSource() {}
+
+  /**
+   * @brief 初始化温度源
+   * @return true 初始化成功, false 初始化失败
+   */
+  virtual bool begin() = 0;
+
+  /**
+   * @brief 发起一次温度测量
+   */
+  virtual void start_measurement() = 0;
+
+  /**
+   * @brief 推进正在进行的测量
+   * @param out_temperature_c 输出参数,测量完成时的温度(°C)
+   * @return true 本次调用完成了测量, false 测量未完成或没有进行中的测量
+   */
+  virtual bool poll(float &out_temperature_c) = 0;
+};
+
+/**
+ * @brief 基于ESP32 ADC的NTC温度源
+ * @note 使用analogReadMilliVolts()读取经eFuse校准的电压,分多次poll()累计过采样
+ */
+class NtcAdcTemperatureSource : public TemperatureSource
+{
+public:
+  /**
+   * @brief NTC阻值-温度对照点结构体
+   */
+  struct NtcPoint
+  {
+    float resistance_ohm; // NTC阻值(Ohm)
+    float temperature_c; // 对应温度(°C)
+  };
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    uint8_t adc_pin = 36; // ADC输入引脚
+    float series_resistor_ohm = 10000.0f; // 分压上拉电阻阻值(Ohm),NTC接在下端
+    float supply_mv = 3300.0f; // 分压电路供电电压(mV)
+    uint16_t oversample_count = 32; // 每次测量的过采样次数
+    uint8_t reads_per_poll = 4; // 每次poll()最多读取的ADC次数
+    const NtcPoint *ntc_table = nullptr; // NTC阻值-温度查表(按阻值降序),nullptr表示使用内置10k B3950表
+    size_t ntc_table_len = 0; // NTC查表长度
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit NtcAdcTemperatureSource(const Config &config);
+
+  bool begin() override;
+  void start_measurement() override;
+  bool poll(float &out_temperature_c) override;
+
+private:
+  /**
+   * @brief 将NTC阻值线性插值换算为温度
+   * @param resistance_ohm NTC阻值(Ohm)
+   * @return 温度(°C)
+   */
+  float get_temperature_from_resistance(float resistance_ohm) const;
+
+  static const NtcPoint k_default_ntc_table_[]; // 内置10k B3950查表
+
+  Config config_{}; // 配置副本
+  bool is_measuring_ = false; // 是否有进行中的测量
+  uint16_t sample_count_ = 0; // 已累计的采样次数
+  uint32_t millivolt_sum_ = 0; // 已累计的电压和(mV)
+};
+
+/**
+ * @brief LM75/TMP102兼容的I2C温度传感器
+ * @note 传感器自行连续转换,poll()只读取一次温度寄存器
+ */
+class Lm75TemperatureSource : public TemperatureSource
+{
+public:
+  /**
+   * @brief 构造函数
+   * @param i2c_address 传感器I2C地址
+   * @param wire I2C总线指针,可与INA226共用
+   */
+  explicit Lm75TemperatureSource(uint8_t i2c_address = 0x48, TwoWire *wire = &Wire);
+
+  bool begin() override;
+  void start_measurement() override;
+  bool poll(float &out_temperature_c) override;
+
+private:
+  /**
+   * @brief 读取温度寄存器
+   * @param out_temperature_c 输出参数,温度(°C)
+   * @return true 读取成功, false 读取失败
+   */
+  bool read_temperature(float &out_temperature_c);
+
+  uint8_t i2c_address_ = 0x48; // 传感器I2C地址
+  TwoWire *wire_ = nullptr; // I2C总线指针
+  bool is_measuring_ = false; // 是否有待读取的测量
+};
@@ -0,0 +1,185 @@
+#include "triggered_event_capture.h" // 包含触发采集的头文件
+
+#include "i2c_bus_arbiter.h" // 包含I2C总线仲裁器
+
+#include <driver/gpio.h> // 包含GPIO中断服务接口
+#include <math.h> // 包含数学库
+
+static constexpr uint32_t k_busy_wait_limit_us = 2000; // 偏移剩余不超过此值时原地等待(us),更长时交还调用者
+
+TriggeredEventCapture::TriggeredEventCapture(const Config &config)
+    : config_(config) // 初始化配置结构体
+{
+  if (config_.current_polarity != -1) // 极性只允许1或-1
+  {
+    config_.current_polarity = 1; // 修正为正极性
+  }
+  if (config_.sample_buffer != nullptr && config_.burst_sample_count > config_.sample_buffer_size) // 采集数超过缓冲容量
+  {
+    config_.burst_sample_count = config_.sample_buffer_size; // 限制为缓冲容量
+  }
+}
+
+bool TriggeredEventCapture::begin()
+{
+  is_ready_ = false; // 先标记未就绪
+  if (config_.sensor == nullptr || config_.burst_sample_count == 0) // 配置无效
+  {
+    return false; // 返回失败
+  }
+
+  {
+    I2cBusLock bus_lock(config_.bus_arbiter, true); // 配置期间占用共享总线
+    if (!bus_lock.is_locked() || !config_.sensor->isConnected()) // 获取总线失败或传感器无响应
+    {
+      return false; // 返回失败
+    }
+    config_.sensor->setAverage(config_.burst_average); // 设置突发采集的平均点数
+    config_.sensor->setBusVoltageConversionTime(config_.burst_conversion_time); // 设置总线转换时间
+    config_.sensor->setShuntVoltageConversionTime(config_.burst_conversion_time); // 设置分流转换时间
+    config_.sensor->setModeShuntBusTrigger(); // 发起一次转换并进入单次触发模式,事件之间不再连续转换
+  }
+
+  if (config_.trigger_gpio >= 0) // 配置了触发输入
+  {
+    pinMode(config_.trigger_gpio, INPUT); // 触发输入
+    const esp_err_t service_err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM); // 安装IRAM中断服务,已安装时返回INVALID_STATE
+    if (service_err != ESP_OK && service_err != ESP_ERR_INVALID_STATE) // 安装失败
+    {
+      return false; // 返回失败
+    }
+    const gpio_num_t gpio = static_cast<gpio_num_t>(config_.trigger_gpio); // 引脚编号
+    gpio_set_intr_type(gpio, config_.is_trigger_rising_edge ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE); // 按配置的边沿触发
+    if (gpio_isr_handler_add(gpio, on_trigger_interrupt, this) != ESP_OK) // 注册中断处理函数
+    {
+      return false; // 返回失败
+    }
+  }
+  is_ready_ = true; // 标记就绪
+  return true; // 初始化成功
+}
+
+bool TriggeredEventCapture::trigger()
+{
+  const uint32_t now_us = micros(); // 触发时刻
+  bool is_accepted = false; // 是否登记成功
+  portENTER_CRITICAL(&trigger_lock_); // 进入临界区,与中断互斥
+  if (is_trigger_pending_) // 上一个事件尚未处理
+  {
+    missed_trigger_count_++; // 计为丢失
+  }
+  else
+  {
+    trigger_us_ = now_us; // 记录触发时刻
+    is_trigger_pending_ = true; // 标记待处理
+    is_accepted = true; // 登记成功
+  }
+  portEXIT_CRITICAL(&trigger_lock_); // 退出临界区
+  return is_accepted; // 返回结果
+}
+
+bool TriggeredEventCapture::poll()
+{
+  if (!is_ready_ || !is_trigger_pending_) // 未初始化或无待处理事件
+  {
+    return false; // 无事可做
+  }
+
+  const uint32_t trigger_us = trigger_us_; // 待处理期间中断不会改写
+  const uint32_t elapsed_us = micros() - trigger_us; // 距触发的时间
+  if (elapsed_us < config_.trigger_offset_us) // 未到偏移
+  {
+    const uint32_t remaining_us = config_.trigger_offset_us - elapsed_us; // 剩余时间
+    if (remaining_us > k_busy_wait_limit_us) // 剩余较长
+    {
+      return false; // 交还调用者,下次再来
+    }
+    delayMicroseconds(remaining_us); // 原地等待,保证与事件对齐
+  }
+
+  const bool is_captured = capture_burst(trigger_us); // 采集本事件
+  portENTER_CRITICAL(&trigger_lock_); // 进入临界区
+  is_trigger_pending_ = false; // 允许下一次触发
+  portEXIT_CRITICAL(&trigger_lock_); // 退出临界区
+  return is_captured; // 返回结果
+}
+
+bool TriggeredEventCapture::is_pending() const
+{
+  return is_trigger_pending_; // 返回是否有待处理的触发
+}
+
+const TriggeredEventCapture::EventStats &TriggeredEventCapture::get_last_event() const
+{
+  return last_event_; // 返回最近一个事件的统计
+}
+
+uint32_t TriggeredEventCapture::get_missed_trigger_count() const
+{
+  return missed_trigger_count_; // 返回丢失次数
+}
+
+void IRAM_ATTR TriggeredEventCapture::on_trigger_interrupt(void *arg)
+{
+  TriggeredEventCapture *capture = static_cast<TriggeredEventCapture *>(arg); // 取回实例指针
+  const uint32_t now_us = micros(); // 触发时刻
+  portENTER_CRITICAL_ISR(&capture->trigger_lock_); // 进入临界区
+  if (capture->is_trigger_pending_) // 上一个事件尚未处理
+  {
+    capture->missed_trigger_count_++; // 计为丢失
+  }
+  else
+  {
+    capture->trigger_us_ = now_us; // 记录触发时刻
+    capture->is_trigger_pending_ = true; // 标记待处理
+  }
+  portEXIT_CRITICAL_ISR(&capture->trigger_lock_); // 退出临界区
+}
+
+bool TriggeredEventCapture::capture_burst(uint32_t trigger_us)
+{
+  I2cBusLock bus_lock(config_.bus_arbiter, true); // 突发期间以高优先级占用总线,样本间隔只受转换时间限制
+  if (!bus_lock.is_locked()) // 获取总线超时
+  {
+    return false; // 返回失败
+  }
+
+  EventStats stats{}; // 本事件统计
+  stats.trigger_us = trigger_us; // 触发时刻
+  stats.start_offset_us = micros() - trigger_us; // 第一个样本转换开始的偏移即实际开始偏移
+  uint32_t window_start_us = stats.start_offset_us; // 本样本时间窗的起点(上一个样本完成转换的时刻)
+  for (uint16_t i = 0; i < config_.burst_sample_count; i++) // 逐个采集
+  {
+    const uint32_t conversion_start_us = micros() - trigger_us; // 本次转换开始时间
+    if (!config_.sensor->setModeShuntBusTrigger() || !config_.sensor->waitConversionReady(config_.conversion_timeout_ms)) // 发起单次转换并等待完成
+    {
+      return false; // 转换失败,丢弃本事件
+    }
+    const uint32_t conversion_end_us = micros() - trigger_us; // 转换完成时间(含轮询延迟)
+    const float current_ma = static_cast<float>(config_.current_polarity) * config_.sensor->getCurrent_mA(); // 读取电流并应用极性
+    const float bus_voltage_v = config_.sensor->getBusVoltage(); // 读取总线电压
+    const float power_mw = bus_voltage_v * current_ma; // 瞬时功率
+
+    if (config_.sample_buffer != nullptr) // 保存样本
+    {
+      config_.sample_buffer[i].offset_us = conversion_start_us + (conversion_end_us - conversion_start_us) / 2; // 样本代表转换期间的平均值,时间取转换中点
+      config_.sample_buffer[i].current_ma = current_ma; // 样本电流
+      config_.sample_buffer[i].bus_voltage_v = bus_voltage_v; // 样本电压
+    }
+    if (fabsf(current_ma) > stats.peak_current_ma) // 更新峰值
+    {
+      stats.peak_current_ma = fabsf(current_ma); // 记录峰值电流
+    }
+    const float window_s = static_cast<float>(conversion_end_us - window_start_us) * 1e-6f; // 本样本的时间窗(s),首个样本为其转换时间
+    stats.charge_mc += current_ma * window_s; // 累加电荷
+    stats.energy_mj += power_mw * window_s; // 累加能量
+    window_start_us = conversion_end_us; // 下一个样本的时间窗从此开始,读取寄存器的时间也被覆盖
+    stats.sample_count++; // 样本计数
+  }
+
+  stats.duration_us = window_start_us - stats.start_offset_us; // 第一个样本转换开始到最后一个样本转换完成
+  stats.mean_current_ma = stats.duration_us > 0 ? stats.charge_mc / (static_cast<float>(stats.duration_us) * 1e-6f) : 0.0f; // 时间加权平均
+  stats.event_index = ++event_count_; // 事件序号
+  last_event_ = stats; // 保存统计
+  return true; // 采集成功
+}
@@ -0,0 +1,129 @@
+#pragma once // 防止头文件重复包含
+
+#include <Arduino.h> // 包含Arduino核心库
+#include <INA226.h> // 包含INA226驱动库
+#include <freertos/FreeRTOS.h> // 包含FreeRTOS基础定义
+
+class I2cBusArbiter; // I2C总线仲裁器(前置声明)
+
+/**
+ * @brief 与负载事件对齐的触发采集
+ * @note 外部GPIO边沿或软件调用发出触发后,在固定偏移处以单次触发模式连续采集N个样本,
+ *       统计每个事件的电荷、峰值电流与能量;两次事件之间传感器处于空闲,不需要持续高速采样
+ * @note 传感器由本类独占,begin()会将其设为突发采集的平均点数与转换时间
+ */
+class TriggeredEventCapture
+{
+public:
+  /**
+   * @brief 单个样本
+   */
+  struct EventSample
+  {
+    uint32_t offset_us = 0; // 相对触发时刻的转换中点(us)
+    float current_ma = 0.0f; // 电流(mA),已应用极性
+    float bus_voltage_v = 0.0f; // 总线电压(V)
+  };
+
+  /**
+   * @brief 单个事件的统计
+   */
+  struct EventStats
+  {
+    uint32_t event_index = 0; // 事件序号(从1开始)
+    uint32_t trigger_us = 0; // 触发时刻(micros())
+    uint32_t start_offset_us = 0; // 实际开始采集时相对触发的偏移(us),可与配置的偏移比较
+    uint32_t duration_us = 0; // 第一个样本转换开始到最后一个样本转换完成的时间(us),包含最后一个样本的时间窗
+    uint16_t sample_count = 0; // 采集到的样本数
+    float peak_current_ma = 0.0f; // 峰值电流绝对值(mA)
+    float mean_current_ma = 0.0f; // 时间加权平均电流(mA)
+    float charge_mc = 0.0f; // 事件电荷(mC,即mA*s),每个样本乘以其时间窗(上一个样本完成到本样本完成)累加
+    float energy_mj = 0.0f; // 事件能量(mJ,即mW*s),与电荷相同的时间窗
+  };
+
+  /**
+   * @brief 配置结构体
+   */
+  struct Config
+  {
+    INA226 *sensor = nullptr; // 采集用的INA226,需由调用者完成校准(setMaxCurrentShunt)
+    int trigger_gpio = -1; // 触发输入引脚,-1表示只使用软件触发
+    bool is_trigger_rising_edge = true; // 上升沿(true)或下降沿(false)触发
+    uint32_t trigger_offset_us = 0; // 触发后延迟多久开始采集(us)
+    uint16_t burst_sample_count = 16; // 每个事件采集的样本数
+    EventSample *sample_buffer = nullptr; // 调用者提供的样本缓冲,nullptr表示只统计不保存样本
+    uint16_t sample_buffer_size = 0; // 样本缓冲容量,保存样本时采集数不超过此值
+    uint8_t burst_average = INA226_1_SAMPLE; // 突发采集的平均点数
+    uint8_t burst_conversion_time = INA226_140_us; // 突发采集的总线与分流转换时间
+    int8_t current_polarity = 1; // 电流极性(1 或 -1)
+    uint32_t conversion_timeout_ms = 10; // 单次转换的超时时间(ms)
+    I2cBusArbiter *bus_arbiter = nullptr; // 共享I2C总线仲裁器,nullptr表示独占总线
+  };
+
+  /**
+   * @brief 构造函数
+   * @param config 配置对象
+   */
+  explicit TriggeredEventCapture(const Config &config);
+
+  /**
+   * @brief 初始化传感器与触发输入
+   * @return true 初始化成功, false 配置无效、传感器无响应或中断注册失败
+   * @note 需要在I2C总线初始化之后调用
+   */
+  bool begin();
+
+  /**
+   * @brief 软件触发一次事件采集
+   * @return true 已登记, false 上一个事件尚未处理完,本次计为丢失
+   */
+  bool trigger();
+
+  /**
+   * @brief 推进事件采集,需在主循环或采集任务中频繁调用
+   * @return true 本次完成了一个事件, false 无待处理事件或未到偏移时间
+   * @note 偏移剩余不超过2ms时原地等待以保证对齐;采集期间阻塞约N次转换的时间
+   */
+  bool poll();
+
+  /**
+   * @brief 是否有待处理的触发
+   * @return true 有, false 无
+   */
+  bool is_pending() const;
+
+  /**
+   * @brief 获取最近一个事件的统计
+   * @return 事件统计的常量引用
+   */
+  const EventStats &get_last_event() const;
+
+  /**
+   * @brief 获取因上一个事件未处理完而丢失的触发次数
+   * @return 丢失次数
+   */
+  uint32_t get_missed_trigger_count() const;
+
+private:
+  /**
+   * @brief 触发输入中断处理函数
+   * @param arg 实例指针
+   */
+  static void on_trigger_interrupt(void *arg);
+
+  /**
+   * @brief 采集一个事件的全部样本并统计
+   * @param trigger_us 触发时刻
+   * @return true 采集成功, false 转换超时或获取总线失败
+   */
+  bool capture_burst(uint32_t trigger_us);
+
+  Config config_{}; // 配置副本
+  bool is_ready_ = false; // 是否已成功初始化
+  portMUX_TYPE trigger_lock_ = portMUX_INITIALIZER_UNLOCKED; // 保护触发状态的自旋锁
+  volatile bool is_trigger_pending_ = false; // 是否有待处理的触发
+  volatile uint32_t trigger_us_ = 0; // 待处理触发的时刻(micros())
+  volatile uint32_t missed_trigger_count_ = 0; // 丢失的触发次数
+  uint32_t event_count_ = 0; // 已完成的事件数
+  EventStats last_event_{}; // 最近一个事件的统计
+};
@@ -1,8 +1,8 @@
 #include <Arduino.h>
 
+#include <battery_event_log.h>
 #include <ina226_battery_monitor.h>
-
-#include <math.h>
+#include <sample_text_formatter.h>
 
 static Ina226BatteryMonitor::Config battery_config = [] {
   Ina226BatteryMonitor::Config config{};
@@ -33,12 +33,23 @@ static Ina226BatteryMonitor::Config battery_config = [] {
 }();
 
 static Ina226BatteryMonitor battery_monitor(battery_config);
+static BatteryEventLog battery_event_log("evlog");
+static SampleTextFormatter sample_formatter;
 
 void setup()
 {
   Serial.begin(115200);
   battery_monitor.set_logger(&Serial);
 
+  if (battery_event_log.begin())
+  {
+    battery_monitor.set_event_log(&battery_event_log);
+  }
+  else
+  {
+    Serial.println("Event log partition not found, events will not be persisted.");
+  }
+
   Serial.println();
   Serial.println(__FILE__);
   Serial.print("INA226_LIB_VERSION: ");
@@ -58,7 +69,7 @@ void setup()
   Serial.println("\nPOWER2 = busVoltage x current");
   Serial.println(" V\t mA \t mW \t mW \t %");
   Serial.println("BUS\tCURRENT\tPOWER\tPOWER2\tSoC");
-  Serial.println("Commands: [R] reset SoC from voltage, [C] clear NVS + reset");
+  Serial.println("Commands: [R] reset SoC from voltage, [C] clear NVS + reset, [D] dump event log, [T<unix s>] set clock, [S] force save + timing");
 }
 
 void loop()
@@ -66,20 +77,8 @@ void loop()
   const uint32_t now_ms = millis();
   battery_monitor.update(now_ms, &Serial);
 
-  const Ina226BatteryMonitor::Sample &sample = battery_monitor.sample();
-
-  Serial.print(sample.bus_voltage_v, 3);
-  Serial.print("\t");
-  Serial.print(fabsf(sample.current_ma), 3);
-  Serial.print("\t");
-  Serial.print(sample.power_mw, 2);
-  Serial.print("\t");
-  Serial.print(sample.power2_mw, 2);
-  Serial.print("\t");
-  Serial.print(sample.soc_percent, 3);
-  Serial.print(" %");
-  Serial.print("\t");
-  Serial.println();
+  const size_t line_length = sample_formatter.format(battery_monitor.sample());
+  Serial.write(sample_formatter.get_line(), line_length);
 
   delay(1000);
 }
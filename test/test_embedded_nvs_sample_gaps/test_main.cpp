@@ -0,0 +1,146 @@
+#include <Arduino.h> // 包含Arduino核心库
+#include <unity.h> // 包含Unity测试框架
+
+#include <ina226_battery_monitor.h> // 包含INA226电池监视器的头文件
+
+static constexpr uint32_t k_sample_period_ms = 10; // 采样周期(ms)
+static constexpr uint32_t k_samples_per_save = 50; // 每隔多少次采样强制保存一次
+static constexpr uint8_t k_forced_save_count = 20; // 强制保存次数
+static constexpr uint32_t k_jitter_ms = 2; // 调度与millis()取整带来的间隔误差(ms)
+static constexpr uint32_t k_gap_threshold_ms = k_sample_period_ms + k_jitter_ms; // 晚于一个周期加误差即计为采样缺口(ms)
+
+/**
+ * @brief 向update()注入串口命令的流,每次只提供一个待读取字符
+ */
+class CommandStream : public Stream
+{
+public:
+  /**
+   * @brief 排入一个命令字符
+   * @param command 命令字符
+   */
+  void push(char command)
+  {
+    pending_ = command; // 覆盖未读取的命令
+  }
+
+  /**
+   * @brief 获取已被读取的命令数
+   * @return 命令数
+   */
+  uint32_t get_consumed_count() const
+  {
+    return consumed_count_; // 返回已读取的命令数
+  }
+
+  int available() override
+  {
+    return pending_ != 0 ? 1 : 0; // 有待读取的命令时为1
+  }
+
+  int read() override
+  {
+    if (pending_ == 0) // 无命令
+    {
+      return -1; // 与串口无数据时一致
+    }
+    const int command = pending_; // 取出命令
+    pending_ = 0; // 清除
+    consumed_count_++; // 计数
+    return command; // 返回命令
+  }
+
+  int peek() override
+  {
+    return pending_ != 0 ? pending_ : -1; // 不取出
+  }
+
+  size_t write(uint8_t value) override
+  {
+    (void)value; // 丢弃输出
+    return 1; // 视为写入成功
+  }
+
+private:
+  char pending_ = 0; // 待读取的命令,0表示无
+  uint32_t consumed_count_ = 0; // 已读取的命令数
+};
+
+/**
+ * @brief 测试用的监视器配置,与src/main.cpp的接线一致,使用独立的NVS命名空间
+ * @return 配置对象
+ */
+static Ina226BatteryMonitor::Config make_test_config()
+{
+  Ina226BatteryMonitor::Config config{}; // 配置对象
+  config.i2c_address = 0x40; // INA226地址
+  config.sda_pin = 32; // SDA引脚
+  config.scl_pin = 33; // SCL引脚
+  config.battery_capacity_mah = 3000.0f; // 电池容量
+  config.shunt_resistor_ohm = 0.002f; // 分流电阻
+  config.max_current_amps = 6.0f; // 最大电流
+  config.nvs_namespace = "battest"; // 不覆盖应用的保存状态
+  config.save_interval_ms = 0xFFFFFFFFu; // 只在强制保存时写NVS
+  config.sample_gap_threshold_ms = k_gap_threshold_ms; // 缺口阈值
+  config.enable_background_nvs_save = true; // 被测行为:NVS提交在写入任务中进行
+  return config; // 返回配置
+}
+
+static Ina226BatteryMonitor s_monitor(make_test_config()); // 被测监视器
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+  s_monitor.clear_nvs_state(); // 清除测试写入的状态
+}
+
+void test_forced_nvs_saves_keep_sample_gaps_bounded()
+{
+  TEST_ASSERT_TRUE_MESSAGE(s_monitor.begin(), "INA226 not responding"); // 需要接好INA226
+  CommandStream commands; // 命令注入流
+  s_monitor.update(millis(), &commands); // 先采样一次,排除begin()到首次采样的间隔
+  s_monitor.reset_sample_gap_stats(); // 从此开始统计
+
+  uint32_t next_sample_ms = millis(); // 下次采样时间
+  uint32_t sample_index = 0; // 采样序号
+  while (commands.get_consumed_count() < k_forced_save_count) // 直到完成全部强制保存
+  {
+    if (static_cast<int32_t>(millis() - next_sample_ms) < 0) // 未到采样时间
+    {
+      continue; // 忙等,不引入额外调度间隔
+    }
+    next_sample_ms += k_sample_period_ms; // 按固定周期排程
+    if (++sample_index % k_samples_per_save == 0) // 到达强制保存点
+    {
+      commands.push('s'); // 在本次update()中强制保存
+    }
+    s_monitor.update(millis(), &commands); // 采样
+  }
+  for (uint32_t i = 0; i < k_samples_per_save; i++) // 最后一次保存之后再采样一段时间,把保存造成的间隔计入统计
+  {
+    delay(k_sample_period_ms); // 采样周期
+    s_monitor.update(millis(), &commands); // 采样
+  }
+
+  const Ina226BatteryMonitor::SampleGapStats &stats = s_monitor.get_sample_gap_stats(); // 采样间隔统计
+  TEST_ASSERT_GREATER_THAN_UINT32(0, stats.max_nvs_save_us); // 写入任务确实完成了NVS写入
+  TEST_ASSERT_EQUAL_UINT32(0, stats.bus_lock_timeout_count); // 没有因总线超时跳过采样
+  const uint32_t max_flash_stall_ms = (stats.max_nvs_save_us + 999) / 1000; // Flash操作是整次写入的一部分,以整次写入耗时为上界
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(k_sample_period_ms + max_flash_stall_ms + k_jitter_ms, stats.max_gap_ms); // 采样只在Flash操作期间停顿
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(k_forced_save_count, stats.gap_count); // 每次保存至多让一次采样迟到,update()不再等待写入
+}
+
+void setup()
+{
+  delay(2000); // 等待串口监视器连接
+  UNITY_BEGIN(); // 开始测试
+  RUN_TEST(test_forced_nvs_saves_keep_sample_gaps_bounded); // 强制保存期间的采样间隔
+  UNITY_END(); // 结束测试
+}
+
+void loop()
+{
+}
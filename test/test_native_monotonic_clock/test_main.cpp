@@ -0,0 +1,68 @@
+#include <unity.h> // 包含Unity测试框架
+
+#include "monotonic_clock.h" // 包含单调时间基准的头文件
+
+static constexpr uint64_t k_epoch_ms = 1767225600000ULL; // 2026-01-01 00:00:00 UTC
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_extend_crosses_32bit_wrap()
+{
+  MonotonicClock clock; // 时间基准
+  TEST_ASSERT_EQUAL_UINT64(0xFFFFFF00ULL, clock.extend(0xFFFFFF00u)); // 回绕前
+  TEST_ASSERT_EQUAL_UINT64(0xFFFFFFFFULL, clock.extend(0xFFFFFFFFu)); // 回绕前最后一毫秒
+  TEST_ASSERT_EQUAL_UINT64(0x100000000ULL, clock.extend(0x00000000u)); // 跨越回绕
+  TEST_ASSERT_EQUAL_UINT64(0x100000100ULL, clock.extend(0x00000100u)); // 回绕后继续累加
+}
+
+void test_small_backward_step_is_ignored()
+{
+  MonotonicClock clock; // 时间基准
+  TEST_ASSERT_EQUAL_UINT64(1000ULL, clock.extend(1000u)); // 起点
+  TEST_ASSERT_EQUAL_UINT64(1000ULL, clock.extend(990u)); // 小幅倒退保持不变,不误判为回绕
+  TEST_ASSERT_EQUAL_UINT64(1000ULL, clock.extend(1000u)); // 回到原时间戳
+  TEST_ASSERT_EQUAL_UINT64(1010ULL, clock.extend(1010u)); // 之后正常前进
+}
+
+void test_resume_from_retained_value()
+{
+  MonotonicClock clock; // 时间基准
+  const uint64_t retained_ms = 0x1234567890ULL; // 复位前保存的单调时间(已超过32位)
+  clock.resume(retained_ms, 50u); // 复位后millis()从较小的值开始
+  TEST_ASSERT_EQUAL_UINT64(retained_ms, clock.extend(50u)); // 复位期间不计入
+  TEST_ASSERT_EQUAL_UINT64(retained_ms + 250ULL, clock.extend(300u)); // 以恢复时的时间戳为基准累加
+  TEST_ASSERT_EQUAL_UINT64(retained_ms + 250ULL, clock.extend(200u)); // 恢复后的小幅倒退同样忽略
+}
+
+void test_record_timestamp_before_and_after_epoch()
+{
+  MonotonicClock clock; // 时间基准
+  const uint64_t before_ms = clock.extend(5000u); // 绝对时间未知时的单调时间
+  TEST_ASSERT_FALSE(clock.has_epoch()); // 尚未设置绝对时间
+  TEST_ASSERT_EQUAL_UINT64(0ULL, clock.to_epoch_ms(before_ms)); // 无法换算为Unix时间
+  TEST_ASSERT_EQUAL_UINT64(before_ms, clock.to_record_timestamp_ms(before_ms)); // 记录时间戳为单调时间
+
+  clock.set_epoch_ms(k_epoch_ms, 6000u); // 在单调时间6000ms时得知绝对时间
+  TEST_ASSERT_TRUE(clock.has_epoch()); // 已知绝对时间
+  TEST_ASSERT_EQUAL_UINT64(k_epoch_ms, clock.to_record_timestamp_ms(6000ULL)); // 设置时刻
+  TEST_ASSERT_EQUAL_UINT64(k_epoch_ms + 1500ULL, clock.to_record_timestamp_ms(clock.extend(7500u))); // 之后按单调时间前进
+  TEST_ASSERT_EQUAL_UINT64(k_epoch_ms - 1000ULL, clock.to_record_timestamp_ms(before_ms)); // 设置前的单调时间也可换算
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc; // 未使用
+  (void)argv; // 未使用
+  UNITY_BEGIN(); // 开始测试
+  RUN_TEST(test_extend_crosses_32bit_wrap); // 跨越0xFFFFFFFF
+  RUN_TEST(test_small_backward_step_is_ignored); // 小幅倒退被忽略
+  RUN_TEST(test_resume_from_retained_value); // 从保存值恢复
+  RUN_TEST(test_record_timestamp_before_and_after_epoch); // 设置绝对时间前后的记录时间戳
+  return UNITY_END(); // 结束测试
+}
@@ -0,0 +1,551 @@
+#pragma once // 防止头文件重复包含
+
+/**
+ * @brief 合成的3S锂电池脉冲负载放电曲线(10s一行,至电压截止),不是实测记录
+ * @note 列: time_s,bus_v,current_ma;基础负载约0.9A,每120s中有30s约2.4A的脉冲,电流在标称值上叠加均匀随机抖动
+ * @note 电压由按放电深度的OCV多项式减去固定60mΩ的内阻压降生成,没有极化、温度与老化效应;
+ *       只用于检验滤波与换算逻辑;实测记录按相同的列格式加入test_main.cpp的k_profiles即可一并回放
+ */
+static const char k_synthetic_discharge_profile_csv[] = R"CSV(time_s,bus_v,current_ma
+0,12.446,899.2
+10,12.442,917.8
+20,12.440,902.5
+30,12.437,904.7
+40,12.435,877.5
+50,12.432,893.4
+60,12.427,922.1
+70,12.426,894.2
+80,12.421,923.2
+90,12.328,2416.1
+100,12.325,2422.0
+110,12.323,2402.8
+120,12.411,892.3
+130,12.409,879.5
+140,12.405,892.7
+150,12.401,901.3
+160,12.400,883.6
+170,12.396,902.2
+180,12.393,891.4
+190,12.390,902.8
+200,12.387,896.3
+210,12.295,2382.1
+220,12.291,2395.2
+230,12.287,2412.5
+240,12.376,876.5
+250,12.372,895.3
+260,12.369,903.1
+270,12.367,875.6
+280,12.363,894.1
+290,12.360,893.9
+300,12.356,912.9
+310,12.354,901.9
+320,12.350,922.8
+330,12.257,2415.2
+340,12.254,2417.6
+350,12.252,2413.1
+360,12.339,900.8
+370,12.338,881.0
+380,12.334,897.8
+390,12.331,885.1
+400,12.329,879.5
+410,12.324,913.8
+420,12.321,915.1
+430,12.317,921.0
+440,12.316,889.6
+450,12.224,2383.0
+460,12.221,2383.7
+470,12.216,2417.3
+480,12.304,899.1
+490,12.301,895.3
+500,12.299,876.4
+510,12.295,891.7
+520,12.293,882.8
+530,12.289,900.1
+540,12.286,903.7
+550,12.284,884.7
+560,12.279,918.1
+570,12.187,2409.4
+580,12.185,2379.0
+590,12.181,2408.7
+600,12.268,896.3
+610,12.265,901.8
+620,12.261,920.6
+630,12.258,924.8
+640,12.255,918.2
+650,12.252,921.9
+660,12.249,922.9
+670,12.248,894.4
+680,12.244,900.9
+690,12.151,2407.8
+700,12.149,2385.2
+710,12.147,2377.8
+720,12.233,892.7
+730,12.231,879.2
+740,12.225,920.9
+750,12.223,907.5
+760,12.222,883.2
+770,12.219,884.3
+780,12.215,899.0
+790,12.212,901.9
+800,12.208,911.0
+810,12.116,2392.1
+820,12.114,2382.0
+830,12.111,2380.1
+840,12.198,880.6
+850,12.195,879.0
+860,12.190,924.1
+870,12.189,886.3
+880,12.186,890.4
+890,12.183,888.2
+900,12.180,887.2
+910,12.176,900.2
+920,12.173,909.9
+930,12.080,2400.8
+940,12.077,2405.2
+950,12.073,2424.5
+960,12.161,907.4
+970,12.158,907.4
+980,12.156,895.8
+990,12.152,918.1
+1000,12.149,913.9
+1010,12.148,877.3
+1020,12.143,916.9
+1030,12.142,880.0
+1040,12.137,919.6
+1050,12.045,2395.8
+1060,12.041,2411.7
+1070,12.038,2417.5
+1080,12.125,921.1
+1090,12.124,886.9
+1100,12.119,911.8
+1110,12.118,876.2
+1120,12.114,899.9
+1130,12.110,910.7
+1140,12.109,880.5
+1150,12.106,879.4
+1160,12.102,897.7
+1170,12.010,2390.9
+1180,12.008,2377.3
+1190,12.002,2421.8
+1200,12.091,887.0
+1210,12.088,897.0
+1220,12.085,887.5
+1230,12.080,923.4
+1240,12.079,893.5
+1250,12.075,909.6
+1260,12.072,902.2
+1270,12.071,880.8
+1280,12.068,875.1
+1290,11.973,2407.4
+1300,11.971,2391.6
+1310,11.969,2383.6
+1320,12.055,898.2
+1330,12.052,897.2
+1340,12.050,887.1
+1350,12.046,891.1
+1360,12.043,896.6
+1370,12.041,882.4
+1380,12.036,914.8
+1390,12.035,887.1
+1400,12.032,879.7
+1410,11.938,2392.6
+1420,11.935,2395.1
+1430,11.933,2380.5
+1440,12.020,881.2
+1450,12.016,903.3
+1460,12.012,922.9
+1470,12.011,892.6
+1480,12.006,923.8
+1490,12.003,915.4
+1500,12.001,909.4
+1510,11.998,896.5
+1520,11.995,911.1
+1530,11.902,2402.9
+1540,11.900,2382.8
+1550,11.895,2418.9
+1560,11.984,880.2
+1570,11.981,884.0
+1580,11.978,893.2
+1590,11.974,910.2
+1600,11.972,895.5
+1610,11.970,878.2
+1620,11.965,903.8
+1630,11.962,900.5
+1640,11.960,886.1
+1650,11.866,2412.7
+1660,11.863,2409.0
+1670,11.862,2379.9
+1680,11.947,902.8
+1690,11.943,921.4
+1700,11.941,904.6
+1710,11.938,909.7
+1720,11.934,919.7
+1730,11.932,911.0
+1740,11.928,917.7
+1750,11.928,875.7
+1760,11.923,903.6
+1770,11.831,2390.9
+1780,11.827,2399.5
+1790,11.823,2418.8
+1800,11.911,912.1
+1810,11.908,909.8
+1820,11.904,919.9
+1830,11.903,882.8
+1840,11.899,912.8
+1850,11.897,889.9
+1860,11.892,923.9
+1870,11.889,915.5
+1880,11.888,889.2
+1890,11.794,2403.1
+1900,11.790,2420.2
+1910,11.790,2379.3
+1920,11.874,915.7
+1930,11.872,903.5
+1940,11.870,895.5
+1950,11.867,881.1
+1960,11.864,894.2
+1970,11.861,892.8
+1980,11.858,893.3
+1990,11.853,916.8
+2000,11.852,883.0
+2010,11.757,2412.3
+2020,11.756,2381.8
+2030,11.751,2423.9
+2040,11.839,903.6
+2050,11.835,916.5
+2060,11.833,902.2
+2070,11.831,878.0
+2080,11.826,918.8
+2090,11.825,884.9
+2100,11.820,918.9
+2110,11.819,883.5
+2120,11.813,917.7
+2130,11.722,2391.6
+2140,11.717,2417.5
+2150,11.714,2422.8
+2160,11.801,918.2
+2170,11.799,910.3
+2180,11.795,924.3
+2190,11.793,896.8
+2200,11.790,894.2
+2210,11.786,911.5
+2220,11.785,884.2
+2230,11.780,908.4
+2240,11.779,880.5
+2250,11.683,2422.6
+2260,11.682,2394.8
+2270,11.678,2410.5
+2280,11.764,918.6
+2290,11.763,885.7
+2300,11.759,900.2
+2310,11.757,892.2
+2320,11.753,906.9
+2330,11.751,882.3
+2340,11.746,911.3
+2350,11.744,890.7
+2360,11.740,910.6
+2370,11.649,2378.0
+2380,11.645,2391.0
+2390,11.641,2408.5
+2400,11.728,905.6
+2410,11.726,884.1
+2420,11.721,906.7
+2430,11.719,894.2
+2440,11.716,882.7
+2450,11.713,888.1
+2460,11.709,895.5
+2470,11.706,895.6
+2480,11.703,899.8
+2490,11.609,2415.6
+2500,11.608,2381.4
+2510,11.603,2407.8
+2520,11.690,901.3
+2530,11.686,912.6
+2540,11.684,897.5
+2550,11.681,897.7
+2560,11.677,898.7
+2570,11.674,908.0
+2580,11.671,893.5
+2590,11.669,879.9
+2600,11.666,877.5
+2610,11.571,2403.6
+2620,11.567,2412.0
+2630,11.563,2420.7
+2640,11.652,885.5
+2650,11.649,895.6
+2660,11.646,884.3
+2670,11.641,915.4
+2680,11.639,895.7
+2690,11.637,878.1
+2700,11.631,915.6
+2710,11.628,911.5
+2720,11.625,907.3
+2730,11.532,2409.1
+2740,11.528,2415.0
+2750,11.525,2413.1
+2760,11.612,897.5
+2770,11.608,917.8
+2780,11.606,895.1
+2790,11.601,921.7
+2800,11.600,886.2
+2810,11.597,883.2
+2820,11.594,875.7
+2830,11.590,881.4
+2840,11.584,921.3
+2850,11.493,2383.8
+2860,11.490,2384.5
+2870,11.486,2393.8
+2880,11.572,902.2
+2890,11.570,875.9
+2900,11.565,906.2
+2910,11.561,908.9
+2920,11.558,909.3
+2930,11.555,893.6
+2940,11.550,923.6
+2950,11.548,897.0
+2960,11.545,888.9
+2970,11.452,2389.4
+2980,11.448,2389.7
+2990,11.445,2390.5
+3000,11.530,908.6
+3010,11.528,882.0
+3020,11.524,888.6
+3030,11.519,913.7
+3040,11.516,916.3
+3050,11.513,894.5
+3060,11.511,880.9
+3070,11.505,920.0
+3080,11.501,922.3
+3090,11.409,2402.8
+3100,11.407,2378.5
+3110,11.402,2401.5
+3120,11.488,895.7
+3130,11.484,912.4
+3140,11.480,907.8
+3150,11.476,914.7
+3160,11.475,883.7
+3170,11.470,891.4
+3180,11.468,878.9
+3190,11.463,892.0
+3200,11.459,905.5
+3210,11.365,2406.1
+3220,11.361,2408.1
+3230,11.357,2407.0
+3240,11.445,883.2
+3250,11.439,922.9
+3260,11.436,910.6
+3270,11.432,914.1
+3280,11.428,914.2
+3290,11.425,897.4
+3300,11.422,892.4
+3310,11.416,924.9
+3320,11.413,907.8
+3330,11.321,2381.2
+3340,11.315,2414.2
+3350,11.312,2401.8
+3360,11.398,905.7
+3370,11.395,885.6
+3380,11.392,875.4
+3390,11.386,913.3
+3400,11.382,910.1
+3410,11.379,886.1
+3420,11.373,923.4
+3430,11.372,878.1
+3440,11.366,912.2
+3450,11.274,2375.2
+3460,11.269,2394.2
+3470,11.263,2416.6
+3480,11.351,889.2
+3490,11.347,883.5
+3500,11.343,895.4
+3510,11.338,901.6
+3520,11.334,894.4
+3530,11.331,882.5
+3540,11.325,915.4
+3550,11.322,891.1
+3560,11.317,901.5
+3570,11.224,2379.4
+3580,11.219,2405.0
+3590,11.214,2401.6
+3600,11.299,923.3
+3610,11.297,881.8
+3620,11.290,921.3
+3630,11.288,888.8
+3640,11.283,894.2
+3650,11.278,907.5
+3660,11.276,875.7
+3670,11.270,902.7
+3680,11.266,885.3
+3690,11.172,2385.9
+3700,11.167,2395.3
+3710,11.163,2392.1
+3720,11.247,916.2
+3730,11.243,906.5
+3740,11.239,883.9
+3750,11.234,905.7
+3760,11.229,904.7
+3770,11.224,910.2
+3780,11.220,899.1
+3790,11.216,891.8
+3800,11.210,914.3
+3810,11.115,2411.5
+3820,11.111,2409.7
+3830,11.108,2379.4
+3840,11.193,887.8
+3850,11.188,877.9
+3860,11.184,878.0
+3870,11.178,882.5
+3880,11.174,876.8
+3890,11.168,892.5
+3900,11.162,920.3
+3910,11.158,895.0
+3920,11.151,922.0
+3930,11.059,2375.6
+3940,11.052,2407.5
+3950,11.047,2418.2
+3960,11.133,902.8
+3970,11.127,909.1
+3980,11.123,895.7
+3990,11.119,876.0
+4000,11.112,900.0
+4010,11.107,896.7
+4020,11.103,882.4
+4030,11.095,919.2
+4040,11.090,920.0
+4050,10.996,2390.3
+4060,10.991,2396.3
+4070,10.986,2386.9
+4080,11.069,911.6
+4090,11.064,909.3
+4100,11.058,920.4
+4110,11.054,892.2
+4120,11.047,918.4
+4130,11.042,898.3
+4140,11.037,898.4
+4150,11.030,912.9
+4160,11.026,882.1
+4170,10.930,2400.5
+4180,10.923,2413.5
+4190,10.919,2389.6
+4200,11.003,895.3
+4210,10.996,902.8
+4220,10.992,877.4
+4230,10.984,913.4
+4240,10.978,921.3
+4250,10.972,910.0
+4260,10.967,895.5
+4270,10.960,911.4
+4280,10.953,923.8
+4290,10.858,2402.6
+4300,10.851,2418.4
+4310,10.847,2383.3
+4320,10.931,882.7
+4330,10.922,923.4
+4340,10.917,910.9
+4350,10.910,915.6
+4360,10.904,911.1
+4370,10.899,895.9
+4380,10.892,901.6
+4390,10.885,912.4
+4400,10.879,901.6
+4410,10.783,2381.0
+4420,10.774,2423.8
+4430,10.768,2413.9
+4440,10.852,914.1
+4450,10.846,893.5
+4460,10.840,885.9
+4470,10.833,888.7
+4480,10.826,880.3
+4490,10.817,923.4
+4500,10.813,877.5
+4510,10.805,893.4
+4520,10.796,917.6
+4530,10.700,2398.7
+4540,10.694,2388.4
+4550,10.687,2378.0
+4560,10.769,890.3
+4570,10.763,878.8
+4580,10.755,877.1
+4590,10.746,903.0
+4600,10.741,877.2
+4610,10.732,890.2
+4620,10.725,883.7
+4630,10.717,900.1
+4640,10.708,911.4
+4650,10.611,2404.3
+4660,10.603,2403.3
+4670,10.597,2384.6
+4680,10.677,922.1
+4690,10.669,909.9
+4700,10.662,905.2
+4710,10.655,886.1
+4720,10.646,909.4
+4730,10.639,888.9
+4740,10.630,902.8
+4750,10.622,891.6
+4760,10.614,893.0
+4770,10.515,2394.8
+4780,10.508,2379.8
+4790,10.499,2387.0
+4800,10.579,921.3
+4810,10.571,896.9
+4820,10.563,898.1
+4830,10.553,913.0
+4840,10.544,914.6
+4850,10.535,918.8
+4860,10.528,889.3
+4870,10.519,901.5
+4880,10.511,881.4
+4890,10.412,2378.4
+4900,10.401,2410.0
+4910,10.394,2379.2
+4920,10.474,892.7
+4930,10.463,911.7
+4940,10.456,880.0
+4950,10.447,877.9
+4960,10.435,923.0
+4970,10.427,896.3
+4980,10.416,908.6
+4990,10.407,897.7
+5000,10.397,900.7
+5010,10.297,2416.5
+5020,10.287,2415.5
+5030,10.276,2423.3
+5040,10.356,923.1
+5050,10.347,904.0
+5060,10.337,906.2
+5070,10.327,906.1
+5080,10.316,921.1
+5090,10.305,924.6
+5100,10.297,880.7
+5110,10.287,885.7
+5120,10.275,901.4
+5130,10.175,2388.0
+5140,10.164,2402.2
+5150,10.154,2385.8
+5160,10.231,923.4
+5170,10.220,909.9
+5180,10.210,899.5
+5190,10.198,910.8
+5200,10.187,908.7
+5210,10.175,917.7
+5220,10.165,893.8
+5230,10.152,920.3
+5240,10.142,907.9
+5250,10.041,2387.4
+5260,10.028,2418.5
+5270,10.018,2379.8
+5280,10.096,884.7
+5290,10.084,883.2
+5300,10.071,903.7
+5310,10.060,880.2
+5320,10.046,917.7
+5330,10.036,876.4
+5340,10.022,899.9
+5350,10.011,877.4
+5360,9.997,893.9
+5370,9.894,2408.8
+5380,9.882,2389.2
+5390,9.870,2386.3
+5400,9.945,910.4
+)CSV";
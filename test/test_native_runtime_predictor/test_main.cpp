@@ -0,0 +1,189 @@
+#include <unity.h> // 包含Unity测试框架
+
+#include <math.h> // 包含数学库
+#include <stdio.h> // 包含sscanf
+#include <string.h> // 包含strchr
+
+#include "discharge_profile.h" // 包含合成放电曲线
+#include "runtime_predictor.h" // 包含剩余时间预测器的头文件
+
+static constexpr uint16_t k_max_rows = 600; // 放电记录最大行数
+static constexpr float k_filter_time_constant_s = 300.0f; // 平滑时间常数(s),大于脉冲周期
+static constexpr uint32_t k_settle_s = 900; // 滤波器稳定所需时间(s),约3个时间常数
+static constexpr float k_max_relative_error = 0.10f; // 剩余时间不少于10min时允许的相对误差
+static constexpr float k_tail_minutes = 10.0f; // 放电末段的长度(min)
+static constexpr float k_max_tail_error_min = 1.5f; // 放电末段允许的绝对误差(min)
+
+/**
+ * @brief 放电记录中的一行
+ */
+struct ProfileRow
+{
+  uint32_t time_s; // 时间(s)
+  float bus_voltage_v; // 总线电压(V)
+  float current_ma; // 电流(mA),放电为正
+};
+
+/**
+ * @brief 回放用的放电记录
+ */
+struct DischargeProfile
+{
+  const char *name; // 名称,用于失败信息
+  const char *csv; // CSV文本,列为time_s,bus_v,current_ma
+};
+
+static const DischargeProfile k_profiles[] = {
+    {"synthetic_3s_pulse", k_synthetic_discharge_profile_csv}, // 合成曲线,不含实测效应
+};
+static constexpr uint8_t k_profile_count = sizeof(k_profiles) / sizeof(k_profiles[0]); // 记录数
+
+static ProfileRow s_rows[k_max_rows]; // 解析后的放电记录
+static uint16_t s_row_count = 0; // 行数
+
+/**
+ * @brief 解析放电记录CSV(跳过表头)
+ * @param csv CSV文本
+ * @return 行数
+ */
+static uint16_t load_profile(const char *csv)
+{
+  uint16_t count = 0; // 行数
+  const char *line = strchr(csv, '\n'); // 跳过表头
+  while (line != nullptr && count < k_max_rows) // 逐行解析
+  {
+    line++; // 跳过换行符
+    ProfileRow row{}; // 当前行
+    if (sscanf(line, "%u,%f,%f", &row.time_s, &row.bus_voltage_v, &row.current_ma) == 3) // 解析成功
+    {
+      s_rows[count++] = row; // 保存
+    }
+    line = strchr(line, '\n'); // 下一行
+  }
+  return count; // 返回行数
+}
+
+/**
+ * @brief 按监视器的积分方式计算记录的总放电量(以放完为满容量)
+ * @return 总放电量(mAh)
+ */
+static double total_discharge_mah()
+{
+  double total_mah = 0.0; // 总放电量
+  for (uint16_t i = 1; i < s_row_count; i++) // 每个周期以本周期电流乘以间隔
+  {
+    total_mah += static_cast<double>(s_rows[i].current_ma) * (s_rows[i].time_s - s_rows[i - 1].time_s) / 3600.0; // 累计
+  }
+  return total_mah; // 返回总放电量
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_profile_loaded()
+{
+  for (uint8_t p = 0; p < k_profile_count; p++) // 每条记录
+  {
+    s_row_count = load_profile(k_profiles[p].csv); // 解析
+    TEST_ASSERT_GREATER_THAN_UINT16_MESSAGE(100, s_row_count, k_profiles[p].name); // 记录足够长
+    TEST_ASSERT_GREATER_THAN_FLOAT_MESSAGE(0.0f, static_cast<float>(total_discharge_mah()), k_profiles[p].name); // 有放电量
+  }
+}
+
+/**
+ * @brief 回放一条放电记录并检查放空时间的误差
+ * @param profile 放电记录
+ */
+static void check_time_to_empty_converges(const DischargeProfile &profile)
+{
+  s_row_count = load_profile(profile.csv); // 解析
+  RuntimePredictor::Config config{}; // 预测器配置
+  config.filter_time_constant_s = k_filter_time_constant_s; // 平滑时间常数
+  config.idle_threshold_ma = 5.0f; // 静置死区
+  RuntimePredictor predictor(config); // 预测器
+
+  const double full_capacity_mah = total_discharge_mah(); // 满容量即整个记录的放电量
+  double remaining_mah = full_capacity_mah; // 剩余容量
+  const uint32_t end_s = s_rows[s_row_count - 1].time_s; // 放电结束时间
+  float max_relative_error = 0.0f; // 稳定后的最大相对误差
+  float max_tail_error_min = 0.0f; // 末段的最大绝对误差
+  for (uint16_t i = 1; i < s_row_count; i++) // 逐行回放
+  {
+    const uint32_t elapsed_s = s_rows[i].time_s - s_rows[i - 1].time_s; // 周期长度
+    remaining_mah -= static_cast<double>(s_rows[i].current_ma) * elapsed_s / 3600.0; // 与监视器相同的库仑计积分
+    const RuntimePredictor::Prediction prediction =
+        predictor.update(elapsed_s * 1000, s_rows[i].current_ma, s_rows[i].bus_voltage_v, remaining_mah, full_capacity_mah); // 更新预测
+    TEST_ASSERT_TRUE(isnan(prediction.time_to_full_min)); // 放电时没有充满时间
+    TEST_ASSERT_FALSE(isnan(prediction.time_to_empty_min)); // 放电时总有放空时间
+
+    if (s_rows[i].time_s < k_settle_s) // 滤波器尚未稳定
+    {
+      continue; // 不检查
+    }
+    const float actual_min = static_cast<float>(end_s - s_rows[i].time_s) / 60.0f; // 实际剩余时间
+    const float error_min = fabsf(prediction.time_to_empty_min - actual_min); // 绝对误差
+    if (actual_min >= k_tail_minutes) // 剩余时间较长时检查相对误差
+    {
+      max_relative_error = fmaxf(max_relative_error, error_min / actual_min); // 记录最大相对误差
+    }
+    else // 放电末段检查绝对误差
+    {
+      max_tail_error_min = fmaxf(max_tail_error_min, error_min); // 记录最大绝对误差
+    }
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_FLOAT_MESSAGE(k_max_relative_error, max_relative_error, profile.name); // 稳定后相对误差在范围内
+  TEST_ASSERT_LESS_OR_EQUAL_FLOAT_MESSAGE(k_max_tail_error_min, max_tail_error_min, profile.name); // 末段收敛到实际剩余时间
+}
+
+void test_time_to_empty_converges_to_actual_remaining_time()
+{
+  for (uint8_t p = 0; p < k_profile_count; p++) // 每条记录
+  {
+    check_time_to_empty_converges(k_profiles[p]); // 回放并检查
+  }
+}
+
+void test_unsmoothed_prediction_follows_pulses()
+{
+  RuntimePredictor::Config config{}; // 预测器配置
+  config.filter_time_constant_s = 0.0f; // 不平滑
+  RuntimePredictor predictor(config); // 预测器
+
+  predictor.update(10000, 900.0f, 12.0f, 1000.0, 2000.0); // 基础负载
+  const RuntimePredictor::Prediction pulse = predictor.update(10000, 2400.0f, 11.9f, 1000.0, 2000.0); // 脉冲负载
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 2400.0f, pulse.avg_current_ma); // 平滑电流等于瞬时电流
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.0f, pulse.time_to_empty_min); // 1000mAh / 2400mA = 25min
+}
+
+void test_idle_and_charging()
+{
+  RuntimePredictor::Config config{}; // 预测器配置
+  config.idle_threshold_ma = 5.0f; // 静置死区
+  RuntimePredictor predictor(config); // 预测器
+
+  const RuntimePredictor::Prediction idle = predictor.update(1000, 2.0f, 12.0f, 1000.0, 2000.0); // 静置
+  TEST_ASSERT_TRUE(isnan(idle.time_to_empty_min)); // 静置不预测放空
+  TEST_ASSERT_TRUE(isnan(idle.time_to_full_min)); // 静置不预测充满
+
+  predictor.reset(); // 重新开始
+  const RuntimePredictor::Prediction charging = predictor.update(1000, -500.0f, 12.4f, 1500.0, 2000.0); // 充电
+  TEST_ASSERT_TRUE(isnan(charging.time_to_empty_min)); // 充电时没有放空时间
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, charging.time_to_full_min); // 500mAh / 500mA = 60min
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc; // 未使用
+  (void)argv; // 未使用
+  UNITY_BEGIN(); // 开始测试
+  RUN_TEST(test_profile_loaded); // 放电记录可解析
+  RUN_TEST(test_time_to_empty_converges_to_actual_remaining_time); // 回放放电记录,放空时间收敛
+  RUN_TEST(test_unsmoothed_prediction_follows_pulses); // 不平滑时跟随脉冲
+  RUN_TEST(test_idle_and_charging); // 静置与充电
+  return UNITY_END(); // 结束测试
+}